@@ -0,0 +1,510 @@
+# ================================================================
+# Author   : German Mundinger
+# Date     : 2023
+# ================================================================
+
+# Generates the per-command part of node.mapper.c from the message schema
+#
+# python3 node_mapper_gen.py node.messages.json lwjson_opts.h node.mapper.schema.h
+
+import json
+import re
+import sys
+
+
+TYPES = {
+    'int32':  { 'is_signed': True,  'min': -2147483647, 'max': 2147483647 },
+    'int16':  { 'is_signed': True,  'min': -32768,      'max': 32767 },
+    'uint16': { 'is_signed': False, 'min': 0,           'max': 65535 },
+}
+
+STORAGES = {
+    'value_0': {
+        'types': ('int32',),
+        'get':   '{msg}->value_0',
+        'set':   '{msg}->value_0 = {value};',
+    },
+    'value_0_high': {
+        'types': ('int16', 'uint16'),
+        'get':   '(int32_t)(({cast})((uint32_t)({msg}->value_0) >> 16U))',
+        'set':   '{msg}->value_0 = (int32_t)(((uint32_t)({msg}->value_0) & 0x0000FFFFUL) | ((uint32_t)((uint16_t)({value})) << 16U));',
+    },
+    'value_0_low': {
+        'types': ('int16', 'uint16'),
+        'get':   '(int32_t)(({cast})((uint16_t)((uint32_t)({msg}->value_0) & 0xFFFFUL)))',
+        'set':   '{msg}->value_0 = (int32_t)(((uint32_t)({msg}->value_0) & 0xFFFF0000UL) | (uint32_t)((uint16_t)({value})));',
+    },
+}
+
+
+class SchemaError(Exception):
+    pass
+
+
+def key_id(key):
+    return key.upper() + '_KEY'
+
+
+def load_key_max_len(path):
+    with open(path, 'r', encoding='utf-8') as opts_file:
+        match = re.search(r'^\s*#define\s+LWJSON_CFG_STREAM_KEY_MAX_LEN\s+(\d+)', opts_file.read(), re.MULTILINE)
+
+    if match is None:
+        raise SchemaError('{}: LWJSON_CFG_STREAM_KEY_MAX_LEN is not defined'.format(path))
+
+    return int(match.group(1))
+
+
+def load_schema(path, key_max_len):
+    with open(path, 'r', encoding='utf-8') as schema_file:
+        schema = json.load(schema_file)
+
+    keys = {}
+
+    for header_key in schema['header_keys']:
+        keys[header_key['key']] = { 'id': header_key['id'], 'field': None }
+
+    for command in schema['commands']:
+        storages = set()
+
+        for field in command['fields']:
+            if field['type'] not in TYPES:
+                raise SchemaError('{}.{}: unknown type {}'.format(command['name'], field['key'], field['type']))
+
+            if field['storage'] not in STORAGES:
+                raise SchemaError('{}.{}: unknown storage {}'.format(command['name'], field['key'], field['storage']))
+
+            if field['type'] not in STORAGES[field['storage']]['types']:
+                raise SchemaError('{}.{}: {} does not fit {}'.format(command['name'], field['key'], field['type'], field['storage']))
+
+            if field['storage'] in storages:
+                raise SchemaError('{}.{}: storage {} is used twice'.format(command['name'], field['key'], field['storage']))
+            storages.add(field['storage'])
+
+            if (('value_0' in storages) and (len(storages) > 1)):
+                raise SchemaError('{}: value_0 overlaps its halves'.format(command['name']))
+
+            for limit in ('min', 'max'):
+                if isinstance(field.get(limit), int):
+                    type_info = TYPES[field['type']]
+
+                    if not (type_info['min'] <= field[limit] <= type_info['max']):
+                        raise SchemaError('{}.{}: {} is out of {}'.format(command['name'], field['key'], limit, field['type']))
+
+            field.setdefault('fraction', 0)
+
+            # JSON text may carry fewer fraction digits than the stored fixed-point value
+            field.setdefault('text_fraction', field['fraction'])
+
+            if not (0 <= field['text_fraction'] <= field['fraction']):
+                raise SchemaError('{}.{}: text_fraction is out of 0..fraction'.format(command['name'], field['key']))
+
+            # A key is parsed before 'cmd_id' may be known, so it must mean the same in every command
+            known = keys.get(field['key'])
+
+            if known is None:
+                keys[field['key']] = { 'id': key_id(field['key']), 'field': field }
+            elif known['field'] is None:
+                raise SchemaError('{}.{}: clashes with a header key'.format(command['name'], field['key']))
+            else:
+                for attribute in ('type', 'storage', 'fraction', 'text_fraction'):
+                    if known['field'][attribute] != field[attribute]:
+                        raise SchemaError('{}.{}: differs in {} from another command'.format(command['name'], field['key'], attribute))
+
+    # A sample history carries a time and values of data keys per sample, it is outbound only
+    for command in schema['commands']:
+        samples = command.get('samples')
+
+        if samples is None:
+            continue
+
+        if command['fields']:
+            raise SchemaError('{}: samples go without fields'.format(command['name']))
+
+        if samples['key'] in keys:
+            raise SchemaError('{}.{}: clashes with another key'.format(command['name'], samples['key']))
+
+        for value in samples['values']:
+            if (value not in keys) or (keys[value]['field'] is None):
+                raise SchemaError('{}.{}: {} is not a data key'.format(command['name'], samples['key'], value))
+
+    # The stream parser cuts longer keys, so they would never match (a sample history is only written)
+    for key in keys:
+        if len(key) > key_max_len:
+            raise SchemaError('{}: longer than LWJSON_CFG_STREAM_KEY_MAX_LEN ({})'.format(key, key_max_len))
+
+    return schema, keys
+
+
+def get_expression(field, msg):
+    cast = 'int16_t' if TYPES[field['type']]['is_signed'] else 'uint16_t'
+
+    return STORAGES[field['storage']]['get'].format(msg=msg, cast=cast)
+
+
+def set_statement(field, msg, value):
+    return STORAGES[field['storage']]['set'].format(msg=msg, value=value)
+
+
+def c_string(text):
+    return '"' + text.replace('\\', '\\\\').replace('"', '\\"') + '"'
+
+
+def c_limit(value):
+    if isinstance(value, int):
+        return '{}L'.format(value)
+
+    return '(int32_t)({})'.format(value)
+
+
+def generate_key_enum(keys):
+    lines = []
+    lines.append('typedef enum node_mapper_key')
+    lines.append('{')
+    lines.append('    UNKNOWN_KEY = 0,')
+
+    key_ids = [key['id'] for key in keys.values()]
+
+    for i, identifier in enumerate(key_ids):
+        separator = ',' if i != (len(key_ids) - 1) else ''
+        lines.append('    {}{}'.format(identifier, separator))
+
+    lines.append('')
+    lines.append('} node_mapper_key_t;')
+
+    return lines
+
+
+def generate_get_key(keys):
+    groups = {}
+
+    for name, key in keys.items():
+        groups.setdefault(len(name), {}).setdefault(name[0], []).append((name, key['id']))
+
+    lines = []
+    lines.append('node_mapper_key_t node_mapper_get_key (const char *name, size_t name_size)')
+    lines.append('{')
+    lines.append('    if (name == NULL)')
+    lines.append('    {')
+    lines.append('        return UNKNOWN_KEY;')
+    lines.append('    }')
+    lines.append('')
+    lines.append('    // Candidate by length and first character, then a single compare of the rest')
+    lines.append('    switch (name_size)')
+    lines.append('    {')
+
+    for length in sorted(groups):
+        lines.append('        case {}U:'.format(length))
+        lines.append('        {')
+        lines.append('            switch (name[0])')
+        lines.append('            {')
+
+        for first in sorted(groups[length]):
+            lines.append("                case '{}':".format(first))
+            lines.append('                {')
+
+            for name, identifier in groups[length][first]:
+                lines.append('                    if (memcmp((const void*)(name + 1U), (const void*)({}), {}U) == 0)'.format(c_string(name[1:]), length - 1))
+                lines.append('                    {')
+                lines.append('                        return {};'.format(identifier))
+                lines.append('                    }')
+
+            lines.append('                    break;')
+            lines.append('                }')
+
+        lines.append('                default:')
+        lines.append('                {')
+        lines.append('                    break;')
+        lines.append('                }')
+        lines.append('            }')
+        lines.append('            break;')
+        lines.append('        }')
+
+    lines.append('        default:')
+    lines.append('        {')
+    lines.append('            break;')
+    lines.append('        }')
+    lines.append('    }')
+    lines.append('    return UNKNOWN_KEY;')
+    lines.append('}')
+
+    return lines
+
+
+def generate_command_switch(signature, commands, generate_case, default_lines, tail_lines):
+    lines = []
+    lines.append(signature)
+    lines.append('{')
+    lines.append('    switch ((int)(msg->cmd_id))')
+    lines.append('    {')
+
+    for command in commands:
+        # Extension commands (not in node_command_id_t) name their id constant
+        lines.append('        case {}:'.format(command.get('id', command['name'])))
+        lines.append('        {')
+        lines.extend(['            ' + line if line else '' for line in generate_case(command)])
+        lines.append('            break;')
+        lines.append('        }')
+
+    lines.append('        default:')
+    lines.append('        {')
+    lines.extend(['            ' + line for line in default_lines])
+    lines.append('            break;')
+    lines.append('        }')
+    lines.append('    }')
+    lines.extend(tail_lines)
+    lines.append('}')
+
+    return lines
+
+
+def generate_is_command_known(schema):
+    def generate_case(command):
+        return ['is_known = true;']
+
+    lines = generate_command_switch('bool node_mapper_is_command_known (node_msg_t const * const msg)',
+                                    schema['commands'], generate_case, [], ['    return is_known;'])
+    lines.insert(2, '    bool is_known = false;')
+    lines.insert(3, '')
+
+    return lines
+
+
+def generate_write_json_data(schema):
+    def generate_case(command):
+        case_lines = []
+
+        for i, field in enumerate(command['fields']):
+            prefix = ',"data":{' if i == 0 else ','
+            case_lines.append('node_mapper_write_text(writer, {});'.format(c_string(prefix + '"' + field['key'] + '":')))
+
+            value = get_expression(field, 'msg')
+            dropped_fraction = field['fraction'] - field['text_fraction']
+
+            if dropped_fraction != 0:
+                value = '({} / {}L)'.format(value, 10 ** dropped_fraction)
+
+            if field['text_fraction'] != 0:
+                case_lines.append('node_mapper_write_decimal(writer, {}, {}U);'.format(value, field['text_fraction']))
+            else:
+                case_lines.append('node_mapper_write_integer(writer, {});'.format(value))
+
+        if command['fields']:
+            case_lines.append("node_mapper_write_char(writer, '}');")
+
+        return case_lines
+
+    return generate_command_switch('void node_mapper_write_json_data (node_mapper_writer_t * const writer, node_msg_t const * const msg)',
+                                   schema['commands'], generate_case, [], ['    return;'])
+
+
+def generate_write_binary_data(schema):
+    def generate_case(command):
+        case_lines = []
+
+        for field in command['fields']:
+            if TYPES[field['type']]['is_signed']:
+                case_lines.append('node_mapper_write_zigzag(writer, {});'.format(get_expression(field, 'msg')))
+            else:
+                case_lines.append('node_mapper_write_varint(writer, (uint32_t){});'.format(get_expression(field, 'msg')))
+
+        return case_lines
+
+    return generate_command_switch('void node_mapper_write_binary_data (node_mapper_writer_t * const writer, node_msg_t const * const msg)',
+                                   schema['commands'], generate_case, [], ['    return;'])
+
+
+def generate_read_binary_data(schema):
+    def generate_case(command):
+        case_lines = []
+
+        for field in command['fields']:
+            if TYPES[field['type']]['is_signed']:
+                value = 'node_mapper_read_zigzag(reader)'
+            else:
+                value = '(int32_t)node_mapper_read_varint(reader)'
+
+            case_lines.append(set_statement(field, 'msg', value))
+
+        return case_lines
+
+    return generate_command_switch('void node_mapper_read_binary_data (node_mapper_reader_t * const reader, node_msg_t * const msg)',
+                                   schema['commands'], generate_case, [], ['    return;'])
+
+
+def generate_write_samples_data(schema, keys):
+    def generate_case(command):
+        samples = command['samples']
+
+        # JSON values are printed like the fields of their keys
+        text_formats = []
+
+        for value in samples['values']:
+            field = keys[value]['field']
+            text_formats.append('{{ {}L, {}U }}'.format(10 ** (field['fraction'] - field['text_fraction']), field['text_fraction']))
+
+        case_lines = []
+        case_lines.append('// [age, {}, then deltas from the previous sample ...]'.format(', '.join(samples['values'])))
+        case_lines.append('if (format == NODE_MAPPER_BINARY_FORMAT)')
+        case_lines.append('{')
+        case_lines.append('    node_mapper_write_varint(writer, (uint32_t)history->size);')
+        case_lines.append('    node_mapper_write_samples(writer, history, time, format, NULL);')
+        case_lines.append('}')
+        case_lines.append('else')
+        case_lines.append('{')
+        case_lines.append('    static const node_mapper_text_format_t text_format_array[NODE_MAPPER_SAMPLE_VALUE_COUNT] = {{ {} }};'.format(', '.join(text_formats)))
+        case_lines.append('')
+        case_lines.append('    node_mapper_write_text(writer, {});'.format(c_string(',"data":{"' + samples['key'] + '":[')))
+        case_lines.append('    node_mapper_write_samples(writer, history, time, format, text_format_array);')
+        case_lines.append('    node_mapper_write_text(writer, "]}");')
+        case_lines.append('}')
+
+        return case_lines
+
+    commands = [command for command in schema['commands'] if 'samples' in command]
+
+    return generate_command_switch('void node_mapper_write_samples_data (node_mapper_writer_t * const writer, node_msg_t const * const msg, node_mapper_history_t const * const history, uint32_t time, node_mapper_format_t format)',
+                                   commands, generate_case, [], ['    return;'])
+
+
+def generate_sample_value_count_check(schema):
+    lines = []
+
+    for command in schema['commands']:
+        if 'samples' in command:
+            lines.append('#if (NODE_MAPPER_SAMPLE_VALUE_COUNT != {}U)'.format(len(command['samples']['values'])))
+            lines.append('#error "{}: NODE_MAPPER_SAMPLE_VALUE_COUNT does not match the schema"'.format(command['name']))
+            lines.append('#endif')
+            lines.append('')
+
+    return lines
+
+
+def generate_set_json_field(keys):
+    lines = []
+    lines.append('void node_mapper_set_json_field (node_msg_t * const msg, node_mapper_key_t key, const char *text, size_t text_capacity)')
+    lines.append('{')
+    lines.append('    switch (key)')
+    lines.append('    {')
+
+    for key in keys.values():
+        field = key['field']
+
+        if field is None:
+            continue
+
+        lines.append('        case {}:'.format(key['id']))
+        lines.append('        {')
+        lines.append('            ' + set_statement(field, 'msg', 'node_mapper_parse_decimal(text, text_capacity, {}U)'.format(field['fraction'])))
+        lines.append('            break;')
+        lines.append('        }')
+
+    lines.append('        default:')
+    lines.append('        {')
+    lines.append('            break;')
+    lines.append('        }')
+    lines.append('    }')
+    lines.append('    return;')
+    lines.append('}')
+
+    return lines
+
+
+def generate_is_data_valid(schema):
+    def generate_case(command):
+        case_lines = []
+
+        for field in command['fields']:
+            value = get_expression(field, 'msg')
+            conditions = []
+
+            if 'values' in field:
+                conditions.append(' || '.join('({} == {})'.format(value, c_limit(allowed)) for allowed in field['values']))
+
+            if 'min' in field:
+                conditions.append('{} >= {}'.format(value, c_limit(field['min'])))
+
+            if 'max' in field:
+                conditions.append('{} <= {}'.format(value, c_limit(field['max'])))
+
+            for condition in conditions:
+                case_lines.append('is_valid = is_valid && ({});'.format(condition))
+
+        return case_lines
+
+    lines = generate_command_switch('bool node_mapper_is_data_valid (node_msg_t const * const msg)',
+                                    schema['commands'], generate_case, [], ['    return is_valid;'])
+    lines.insert(2, '    bool is_valid = true;')
+    lines.insert(3, '')
+
+    return lines
+
+
+def generate(schema_path, schema, keys):
+    schema_name = schema_path.replace('\\', '/').split('/')[-1]
+
+    lines = []
+    lines.append('/************************************************************')
+    lines.append(' *   Generated from {} by node_mapper_gen.py'.format(schema_name))
+    lines.append(' *   Do not edit, it is included by node.mapper.c only')
+    lines.append(' ************************************************************/')
+    lines.append('')
+    lines.append('#ifndef NODE_MAPPER_SCHEMA_H')
+    lines.append('#define NODE_MAPPER_SCHEMA_H')
+    lines.append('')
+    lines.append('#if LWJSON_CFG_STREAM_KEY_MAX_LEN < {}'.format(max(len(key) for key in keys)))
+    lines.append('#error "The longest schema key does not fit LWJSON_CFG_STREAM_KEY_MAX_LEN, regenerate the mapper"')
+    lines.append('#endif')
+    lines.append('')
+    lines.extend(generate_key_enum(keys))
+    lines.append('')
+    lines.append('')
+    lines.append('static node_mapper_key_t node_mapper_get_key (const char *name, size_t name_size);')
+    lines.append('static bool node_mapper_is_command_known (node_msg_t const * const msg);')
+    lines.append('static bool node_mapper_is_data_valid (node_msg_t const * const msg);')
+    lines.append('')
+    lines.append('static void node_mapper_write_json_data (node_mapper_writer_t * const writer, node_msg_t const * const msg);')
+    lines.append('static void node_mapper_set_json_field (node_msg_t * const msg, node_mapper_key_t key, const char *text, size_t text_capacity);')
+    lines.append('')
+    lines.append('static void node_mapper_write_binary_data (node_mapper_writer_t * const writer, node_msg_t const * const msg);')
+    lines.append('static void node_mapper_read_binary_data (node_mapper_reader_t * const reader, node_msg_t * const msg);')
+    lines.append('')
+    lines.append('static void node_mapper_write_samples_data (node_mapper_writer_t * const writer, node_msg_t const * const msg, node_mapper_history_t const * const history, uint32_t time, node_mapper_format_t format);')
+    lines.append('')
+    lines.extend(generate_sample_value_count_check(schema))
+
+    for function in (generate_get_key(keys),
+                     generate_is_command_known(schema),
+                     generate_is_data_valid(schema),
+                     generate_write_json_data(schema),
+                     generate_set_json_field(keys),
+                     generate_write_binary_data(schema),
+                     generate_read_binary_data(schema),
+                     generate_write_samples_data(schema, keys)):
+        lines.extend(function)
+        lines.append('')
+
+    lines.append('#endif // NODE_MAPPER_SCHEMA_H')
+
+    return '\n'.join(lines)
+
+
+def main():
+    if len(sys.argv) != 4:
+        sys.stderr.write('usage: node_mapper_gen.py <schema.json> <lwjson_opts.h> <output.h>\n')
+        return 1
+
+    try:
+        schema, keys = load_schema(sys.argv[1], load_key_max_len(sys.argv[2]))
+    except (SchemaError, KeyError) as error:
+        sys.stderr.write('{}: {}\n'.format(sys.argv[1], error))
+        return 1
+
+    with open(sys.argv[3], 'w', encoding='utf-8', newline='\n') as output_file:
+        output_file.write(generate(sys.argv[1], schema, keys))
+
+    return 0
+
+
+if __name__ == '__main__':
+    sys.exit(main())
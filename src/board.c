@@ -6,6 +6,8 @@
 #include "board.h"
 #include "board.types.h"
 
+#include <string.h>
+
 #include <avr/io.h>
 #include <avr/interrupt.h>
 #include <avr/power.h>
@@ -17,11 +19,19 @@
 #include "mcu/uart.h"
 #include "mcu/spi.h"
 #include "mcu/int_0.h"
+#include "mcu/timer_0.h"
 #include "mcu/timer_1.h"
+#include "mcu/timer_2.h"
+#include "mcu/watchdog.h"
 #include "mcu/adc.h"
 
 #include "tcp_client.h"
 #include "node.mapper.h"
+#include "timer_wheel.h"
+#include "scheduler.h"
+#include "event_queue.h"
+#include "energy_meter.h"
+#include "coroutine.h"
 
 #include "board_b02.h"
 
@@ -29,10 +39,72 @@
 #include "logger.h"
 
 
-#define LIGHT_SENSOR_CYCLE_COUNT    4U      //  * 7,5 sec = ~ min
+#define LIGHT_SENSOR_PERIOD_MS      30000UL
+#define LIGHT_SENSOR_RETRY_MS       7500UL  // The measurement is put off while the light is on
 #define LIGHT_SENSOR_DARK_THRESHOLD 100U 
 
+#define NETWORK_PERIOD_MS       7500UL  // Reconnection and retries of failed messages
+
+#ifdef NODE_POWER_DOWN
+#define CLOCK_CYCLE_MS          7500UL  // Uptime unit, as long as a Timer1 cycle of the default build
+#define CLOCK_BASE_TIMEOUT      WATCHDOG_TIMEOUT_250MS  // The tick while there is no deadline
+#define CLOCK_MAX_TIMEOUT       WATCHDOG_TIMEOUT_2S     // Bounds the delay of a deadline set in the middle of a tick
+#define CLOCK_WAKE_TOLERANCE_MS 64UL    // A longer tick may overshoot the deadline by this (the watchdog oscillator is accurate to ~10 %)
+#define CLOCK_BASE_WAKEUP_COUNT 30U     // Clock wake-ups per cycle with the former fixed 250 ms tick
+#else
+// The clock is the LED PWM: Timer1 cycles counted by its TOP interrupt and the counter within the current cycle,
+// read on demand. The phase correct PWM counts down from TOP and back up, the BOTTOM flag tells the halves apart
+#define CLOCK_TIMER1_TOP        50782U  // ~3.25 s per half
+#define CLOCK_CYCLE_TICKS       (2UL * CLOCK_TIMER1_TOP)    // Uptime unit, ~6.5 s
+#define CLOCK_STEP_TICKS        125U    // Timer1 and Timer2 ticks (16 MHz / 1024 = 64 us) per 'CLOCK_STEP_MS'
+#define CLOCK_STEP_MS           8UL
+// A deadline within the 8-bit Timer2 range wakes the MCU up with a one-shot compare, a farther one is taken at the next
+// wake-up (the next TOP at the latest), so the clock alone wakes the MCU up once per cycle while nothing is close
+#define CLOCK_ALARM_MAX_MS      16L     // Up to 255 Timer2 ticks with the rounding
+#define CLOCK_BASE_WAKEUP_COUNT 1U      // Clock wake-ups per cycle with the former Timer1 interrupt
+#endif // NODE_POWER_DOWN
+
+#ifdef NODE_POWER_DOWN
+#define WATCHDOG_HANG_TIME_MS   8000U   // Without the main loop for longer, the watchdog tick records the hang and resets the MCU
+#else
+#define WATCHDOG_HANG_TIMEOUT   WATCHDOG_TIMEOUT_8S // Without the main loop for longer, the watchdog interrupt does the same (longer than a Timer1 cycle)
+#endif // NODE_POWER_DOWN
+#define HANG_RECORD_MAGIC       0x4847U // RAM is random after a power loss, the record is only valid with it
+#define HANG_STACK_SIZE         32U     // Bytes of the interrupted code stack, with the return addresses of its callers
+
+#define ENERGY_REPORT_PERIOD_MS 60000UL // Up to ENERGY_METER_MAX_PERIOD_MS
+#define CLOCK_TICK_US           64UL    // Timer0, Timer1 and Timer2 at 16 MHz / 1024
+
+#ifdef NODE_POWER_DOWN
+#define AWAKE_CLOCK_TICKS       250U    // Timer0 only runs while the MCU is awake, 16 ms per interval
+#endif // NODE_POWER_DOWN
+
+// Rough datasheet figures (5 V, 16 MHz), the ones measured on the node go here
+#define MCU_ACTIVE_CURRENT_UA   9000U
+#ifdef NODE_POWER_DOWN
+#define MCU_SLEEP_CURRENT_UA    7U      // Power-down with the watchdog
+#else
+#define MCU_SLEEP_CURRENT_UA    2700U   // Idle
+#endif // NODE_POWER_DOWN
+#define BOARD_BASE_CURRENT_UA   132000UL // W5500 with a 100 Mbps link
+
+#ifdef NODE_POWER_DOWN
+
+#define LED_ON_TIME_MS          500UL   // Timer1 stops in power-down, so the LED flashes instead of fading
+#define LED_OFF_TIME_MS         (CLOCK_CYCLE_MS - LED_ON_TIME_MS)
+#define LIGHT_SENSOR_SETTLE_TIME_MS (LED_OFF_TIME_MS / 2UL) // The light is measured in the middle of the LED off-phase, like at Timer1 TOP
+#endif // NODE_POWER_DOWN
+
 #define MESSAGE_SEND_RETRY_COUNT 4U
+#define MESSAGE_BATCH_MAX_SIZE  256U    // Bytes per segment, the rest of the pending messages go into the next one
+#define MESSAGE_BATCH_SEPARATOR "\n"    // Between JSON messages (binary ones carry their length)
+#define MESSAGE_CACHE_SIZE      16U     // Bytes per slot, enough for every binary message (a JSON one is serialized again on retry)
+
+#ifdef NODE_BINARY_FORMAT
+#define DEFAULT_MESSAGE_FORMAT NODE_MAPPER_BINARY_FORMAT
+#else
+#define DEFAULT_MESSAGE_FORMAT NODE_MAPPER_JSON_FORMAT
+#endif // NODE_BINARY_FORMAT
 
 #define UART_BAUDRATE 9600U
 
@@ -40,22 +112,57 @@
 #define W5500_PORT_CS   PORTD
 #define W5500_PIN_CS    PORTD4
 
+#ifdef NODE_POWER_DOWN
+#define LED_DDR     DDRB
+#define LED_PORT    PORTB
+#define LED_PIN_A   PORTB1  // Timer1 OC1A
+#define LED_PIN_B   PORTB2  // Timer1 OC1B
+#endif // NODE_POWER_DOWN
+
+#define W5500_ETHER_TYPE 0x88B5U // IEEE local experimental EtherType (MACRAW transport)
+
+#if defined(NODE_BACKUP_HUB_IP) && !defined(NODE_BACKUP_HUB_PORT)
+#define NODE_BACKUP_HUB_PORT host_port
+#endif // NODE_BACKUP_HUB_IP
+
 #define ARRAY_SIZE(array) (sizeof(array) / sizeof((array)[0]))
 #define UNUSED(x) (void)(x)
 
 
 typedef void (*board_extra_init_callback_t) ();
 typedef void (*board_extra_process_callback_t) (board_basic_state_t const * const basic_state, board_extra_state_t * const extra_state);
-typedef void (*board_extra_is_interrupt_callback_t) (bool * const is_interrupt);
 
 typedef struct board_extra_strategy
 {
     board_extra_init_callback_t init_callback;
-    board_extra_process_callback_t process_callback;
-    board_extra_is_interrupt_callback_t is_interrupt_callback;
+    board_extra_process_callback_t process_callback; // Runs on BOARD_EXTRA_EVENT and BOARD_STATE_EVENT
 
 } board_extra_strategy_t;
 
+typedef struct board_ack
+{
+    node_id_t dest_id;
+    node_command_id_t cmd_id;
+    uint16_t request_id;
+
+} board_ack_t;
+
+typedef struct board_msg_cache
+{
+    char raw_data[MESSAGE_CACHE_SIZE];
+    uint8_t raw_data_size; // 0 - nothing is cached
+
+} board_msg_cache_t;
+
+typedef struct board_hang_record
+{
+    uint16_t magic;
+    uint16_t address;   // Byte address of the interrupted code
+    uint8_t stack_array[HANG_STACK_SIZE];
+    uint8_t stack_size;
+
+} board_hang_record_t;
+
 typedef enum timer_1_gpio
 {
     GPIO_A = 0,
@@ -64,54 +171,185 @@ typedef enum timer_1_gpio
 } timer_1_gpio_t;
 
 
-static volatile size_t timer1_overflow_count;
-static volatile bool is_int_0_interrupt;
+static volatile size_t clock_cycle_count;
+static volatile uint32_t clock_time_ms;    // At the start of the current cycle in the default build
+static volatile uint32_t clock_wake_time_ms;
+static volatile bool is_clock_wake_time_set;
+static volatile uint16_t clock_wakeup_count;        // In the current cycle
+static volatile uint16_t clock_cycle_wakeup_count;  // In the last complete cycle
+
+#ifdef NODE_POWER_DOWN
+static volatile uint32_t clock_cycle_time_ms;
+static volatile watchdog_timeout_t clock_timeout;
+static volatile uint16_t watchdog_unfed_time_ms;
+static volatile uint32_t awake_clock_time_us;
 
-static bool is_w5500_interrupt;
+static timer_wheel_timer_t led_timer;
+static timer_1_gpio_t led_gpio;
+static bool is_led_on;
+#else
+static volatile uint16_t clock_tick_fraction; // Timer1 ticks short of 'CLOCK_STEP_MS' at the start of the current cycle
+static volatile bool is_clock_starting;       // Timer1 starts at BOTTOM without its flag, in the second half of the first cycle
+#endif // NODE_POWER_DOWN
 
 static board_basic_state_t basic_state;
 static board_extra_state_t extra_state;
 
-static tcp_msg_t tcp_msg;
+static node_mapper_format_t tcp_msg_format;
+
+static coroutine_t send_coroutine;
+static size_t send_msg_index;
+static bool is_in_batch_array[BOARD_MSG_SIZE];
+static uint8_t batch_retry_count_array[BOARD_MSG_SIZE]; // Messages are not pending while they are being sent
+static size_t batch_sample_count;
+static board_msg_cache_t msg_cache_array[BOARD_MSG_SIZE]; // Binary messages of the slots, for their retries
+static board_msg_cache_t *filling_msg_cache;
+static bool is_tcp_client_connected;
+#ifdef NODE_DIAGNOSTICS
+static uint32_t mapper_time_us; // Serialization into the W5500 TX buffer, since the last log
+static uint16_t mapper_msg_count;
+static uint16_t mapper_byte_count;
+#endif // NODE_DIAGNOSTICS
+
+static board_ack_t held_ack_array[BOARD_ACK_MSG_COUNT]; // Received commands wait for the state task to apply them
+static size_t held_ack_count;
+
+static timer_wheel_timer_t light_sensor_timer;
+static coroutine_t light_sensor_coroutine;
+static volatile bool is_light_conversion_requested; // Till the LED off-phase
+static volatile bool is_light_conversion_running;
+static volatile uint16_t light_adc_value;
+#ifdef NODE_POWER_DOWN
+static timer_wheel_timer_t light_sensor_wait_timer;
+#endif // NODE_POWER_DOWN
+static timer_wheel_timer_t network_timer;
+static timer_wheel_timer_t energy_timer;
+static uint32_t energy_report_time_ms;
 
 static node_id_t node_id;
 static board_extra_strategy_t extra_strategy;
 
-
-static void board_timer1_overflow_ISR ();
+static board_hang_record_t hang_record __attribute__((section(".noinit")));
+
+
+#ifdef NODE_POWER_DOWN
+static void board_watchdog_ISR ();
+static void board_timer0_compare_ISR ();
+#else
+static void board_watchdog_hang_ISR ();
+static void board_timer2_compare_ISR ();
+#endif // NODE_POWER_DOWN
+static void board_record_hang ();
+static void board_report_hang (uint8_t reset_flags);
+#ifdef NODE_POWER_DOWN
+static void board_tick_clock (uint32_t tick_ms);
+#else
+static uint32_t board_get_cycle_ticks ();
+#endif // NODE_POWER_DOWN
+static void board_end_clock_cycle ();
+static void board_check_clock_wake (uint32_t time_ms);
+static void board_program_clock ();
+static uint32_t board_get_time_ms ();
+static uint32_t board_get_awake_time_us ();
+static uint8_t board_get_powered_peripherals ();
+static void board_feed_watchdog ();
 static void board_int_0_ISR ();
 
 static void w5500_spi_select ();
 static void w5500_spi_unselect ();
 
+static void board_start_led (timer_1_gpio_t gpio);
+static void board_switch_led (timer_1_gpio_t gpio);
+static void board_init_watchdog ();
+#ifdef NODE_POWER_DOWN
+static void board_init_timer0 ();
+#else
 static void board_init_timer1 (timer_1_gpio_t gpio);
-static void board_deinit_timer1 ();
+static void board_start_clock_alarm (uint8_t ticks);
+static void board_stop_clock_alarm ();
+#endif // NODE_POWER_DOWN
+static void board_init_int_0 ();
 static void board_init_spi ();
 static void board_deinit_spi ();
 static void board_init_adc ();
 static void board_deinit_adc ();
 
+#ifdef NODE_DIAGNOSTICS
+static void board_log_diagnostics (scheduler_event_mask_t event_mask, bool is_new_cycle);
+#endif // NODE_DIAGNOSTICS
 static void board_init_logging ();
+static void board_write_log_byte (uint8_t byte);
 static void board_init_strategy ();
 static void board_init_tcp_client ();
-
-static void board_process_tcp_client ();
-static void board_process_light_sensor ();
-static void board_process_led ();
+static void board_init_scheduler ();
+static void board_init_event_queue ();
+static void board_init_timer_wheel ();
+static void board_init_energy_meter ();
+
+static void board_process_timers (scheduler_event_mask_t event_mask);
+static void board_process_tcp_client (scheduler_event_mask_t event_mask);
+static coroutine_state_t board_send_messages ();
+static size_t board_send_message_batch (size_t msg_index);
+static void board_end_message_batch (int exit_code);
+static int board_append_message (size_t msg_index, std_error_t * const error);
+static void board_append_message_chunk (const char *chunk, size_t chunk_size);
+static int board_send_history ();
+static void board_end_history (int exit_code);
+static int board_get_sending_result ();
+static void board_receive_tcp_chunk (const char *chunk, size_t chunk_size);
+static void board_process_message (node_msg_t const * const node_msg, node_mapper_format_t format, uint16_t request_id);
+static void board_hold_ack (node_msg_t const * const node_msg, uint16_t request_id);
+static void board_queue_ack (board_ack_t const * const ack);
+static void board_process_extra (scheduler_event_mask_t event_mask);
+static void board_process_light_sensor (scheduler_event_mask_t event_mask);
+static coroutine_state_t board_measure_light ();
+static void board_process_led (scheduler_event_mask_t event_mask);
+static void board_process_state (scheduler_event_mask_t event_mask);
+
+static void board_light_sensor_timer_callback ();
+static void board_start_light_conversion ();
+static void board_adc_ISR (uint16_t adc_value);
+#ifdef NODE_POWER_DOWN
+static void board_light_sensor_wait_timer_callback ();
+#else
+static void board_timer1_top_ISR ();
+#endif // NODE_POWER_DOWN
+static void board_network_timer_callback ();
+static void board_energy_timer_callback ();
+#ifdef NODE_POWER_DOWN
+static void board_led_timer_callback ();
+#endif // NODE_POWER_DOWN
 
 void board_init ()
 {
-    wdt_enable(WDTO_8S);
-    
-    power_all_disable();
-    set_sleep_mode(SLEEP_MODE_IDLE);
+    // Taken before the watchdog clears its flag
+    const uint8_t reset_flags = MCUSR;
 
-    timer1_overflow_count   = 0U;
-    is_int_0_interrupt      = false;
+    board_init_watchdog();
 
-    is_w5500_interrupt = false;
+    power_all_disable();
+#ifdef NODE_POWER_DOWN
+    set_sleep_mode(SLEEP_MODE_PWR_DOWN);
+#else
+    set_sleep_mode(SLEEP_MODE_IDLE);
+#endif // NODE_POWER_DOWN
+
+    clock_cycle_count           = 0U;
+    clock_time_ms               = 0UL;
+    clock_wake_time_ms          = 0UL;
+    is_clock_wake_time_set      = false;
+    clock_wakeup_count          = 0U;
+    clock_cycle_wakeup_count    = 0U;
+#ifdef NODE_POWER_DOWN
+    clock_cycle_time_ms         = 0UL;
+#else
+    clock_tick_fraction         = 0U;
+    is_clock_starting           = true;
+#endif // NODE_POWER_DOWN
 
     basic_state.global_cycle_count          = 0U;
+    basic_state.uptime_cycle_count          = 0UL;
+    basic_state.time_ms                     = 0UL;
     basic_state.is_dark                     = false;
     basic_state.is_enable_light_command     = false;
     basic_state.is_disable_light_command    = false;
@@ -123,21 +361,80 @@ void board_init ()
     extra_state.is_msg_to_send  = false;
     extra_state.is_light_on     = false;
 
-    tcp_msg.size = 0U;
+    for (size_t i = 0U; i < ARRAY_SIZE(is_in_batch_array); ++i)
+    {
+        is_in_batch_array[i] = false;
+        msg_cache_array[i].raw_data_size = 0U;
+    }
+    filling_msg_cache = NULL;
+#ifdef NODE_DIAGNOSTICS
+    mapper_time_us      = 0UL;
+    mapper_msg_count    = 0U;
+    mapper_byte_count   = 0U;
+#endif // NODE_DIAGNOSTICS
+
+    COROUTINE_INIT(&send_coroutine);
+    COROUTINE_INIT(&light_sensor_coroutine);
+    is_light_conversion_requested   = false;
+    is_light_conversion_running     = false;
+    light_adc_value                 = 0U;
+
+    node_mapper_clear_history(&extra_state.history);
+    extra_state.is_history_to_send = false;
+
+    tcp_msg_format = DEFAULT_MESSAGE_FORMAT;
+    is_tcp_client_connected = false;
+    held_ack_count = 0U;
+
+    // Logging is metered from the first byte
+    board_init_energy_meter();
 
 #ifndef NDEBUG
     board_init_logging();
 #endif // NDEBUG
 
+    board_init_scheduler();
+    board_init_event_queue();
+
+    board_init_timer_wheel();
+
+    timer_wheel_init_timer(&light_sensor_timer, board_light_sensor_timer_callback);
+    timer_wheel_start(&light_sensor_timer, LIGHT_SENSOR_PERIOD_MS, LIGHT_SENSOR_PERIOD_MS);
+#ifdef NODE_POWER_DOWN
+    timer_wheel_init_timer(&light_sensor_wait_timer, board_light_sensor_wait_timer_callback);
+#endif // NODE_POWER_DOWN
+
+    timer_wheel_init_timer(&network_timer, board_network_timer_callback);
+    timer_wheel_start(&network_timer, NETWORK_PERIOD_MS, NETWORK_PERIOD_MS);
+
+    timer_wheel_init_timer(&energy_timer, board_energy_timer_callback);
+    timer_wheel_start(&energy_timer, ENERGY_REPORT_PERIOD_MS, ENERGY_REPORT_PERIOD_MS);
+    energy_report_time_ms = board_get_time_ms();
+
+#ifdef NODE_POWER_DOWN
+    timer_wheel_init_timer(&led_timer, board_led_timer_callback);
+    is_led_on = false;
+#endif // NODE_POWER_DOWN
+
     board_init_strategy();
+
+    // The report is sent from the node id
+    board_report_hang(reset_flags);
+
     board_init_tcp_client();
 
     extra_strategy.init_callback();
 
-    board_init_timer1(GPIO_A);
+    board_start_led(GPIO_A);
+#ifdef NODE_POWER_DOWN
+    board_init_timer0();
+#endif // NODE_POWER_DOWN
 
     //_delay_ms(1000);
 
+    // Connect and apply the initial state right away
+    scheduler_post_event(BOARD_NETWORK_EVENT | BOARD_STATE_EVENT);
+
     sei();
 
     return;
@@ -147,51 +444,105 @@ void board_launch ()
 {
     while (true)
     {
-        wdt_reset();
+        energy_meter_switch(BOARD_LOOP_ACTIVITY);
+
+        board_feed_watchdog();
 
-        LOG("Loop\r\n");
+        const size_t prev_cycle_count = basic_state.global_cycle_count;
 
         ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
         {
-            basic_state.global_cycle_count = timer1_overflow_count;
+            basic_state.global_cycle_count = clock_cycle_count;
+        }
+        basic_state.uptime_cycle_count += (uint32_t)(basic_state.global_cycle_count - prev_cycle_count);
+        basic_state.time_ms = board_get_time_ms();
+
+        // Only the tasks subscribed to the posted events run
+        const scheduler_event_mask_t event_mask = scheduler_run();
 
-            is_w5500_interrupt = is_int_0_interrupt;
-            is_int_0_interrupt = false;
+#ifdef NODE_DIAGNOSTICS
+        board_log_diagnostics(event_mask, basic_state.global_cycle_count != prev_cycle_count);
+#else
+        UNUSED(event_mask);
+#endif // NODE_DIAGNOSTICS
+
+        // A message pass in progress takes the new messages or leaves them for the next one
+        if ((extra_state.is_msg_to_send == true) && (COROUTINE_IS_RUNNING(&send_coroutine) == false))
+        {
+            scheduler_post_event(BOARD_MSG_EVENT);
         }
 
-        board_process_tcp_client();
-        extra_strategy.process_callback(&basic_state, &extra_state);
-        board_process_light_sensor();
-        board_process_led();
+        uint32_t wake_time_ms;
+        const bool is_wake_time_set = timer_wheel_get_next_deadline(&wake_time_ms);
+
+        board_feed_watchdog();
+
+        cli();
 
-        basic_state.current_mode = basic_state.new_mode;
-        basic_state.is_enable_light_command = false;
-        basic_state.is_disable_light_command = false;
+        // The clock posts BOARD_TIMER_EVENT at the next timer deadline, its other ticks do not run the tasks
+        clock_wake_time_ms      = wake_time_ms;
+        is_clock_wake_time_set  = is_wake_time_set;
 
-        wdt_reset();
+        board_check_clock_wake(board_get_time_ms());
 
-        // Enter to sleep mode
-        if (extra_state.is_msg_to_send != true)
+#ifdef NODE_POWER_DOWN
+        // The ADC clock stops in power-down
+        set_sleep_mode((is_light_conversion_running == true) ? SLEEP_MODE_IDLE : SLEEP_MODE_PWR_DOWN);
+#else
+        // A close deadline gets its own wake-up
+        board_program_clock();
+#endif // NODE_POWER_DOWN
+
+        energy_meter_sleep();
+
+        // Enter to sleep mode until an event
+        while (scheduler_is_event_pending() == false)
         {
+            sleep_enable();
+            sleep_bod_disable();
+            sei();
+            sleep_cpu();
+            sleep_disable();
             cli();
 
-            bool is_extra_interrupt;
-            extra_strategy.is_interrupt_callback(&is_extra_interrupt);
+            board_feed_watchdog();
+        }
+        sei();
+    }
+}
+
+#ifdef NODE_DIAGNOSTICS
+void board_log_diagnostics (scheduler_event_mask_t event_mask, bool is_new_cycle)
+{
+    // Every loop pass, the UART keeps the MCU awake for ~1 ms per byte
+    LOG("Events: %x\r\n", (unsigned)(event_mask));
+    UNUSED(event_mask);
 
-            const bool is_interrupt = (is_int_0_interrupt != false) || (is_extra_interrupt != false);
+    if (is_new_cycle == true)
+    {
+        uint16_t wakeup_count;
 
-            if (is_interrupt != true)
-            {
-                sleep_enable();
-                sleep_bod_disable();
-                sei();
-                sleep_cpu();
-                sleep_disable();
-            }
-            sei();
+        ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+        {
+            wakeup_count = clock_cycle_wakeup_count;
+        }
+
+        LOG("Clock wake-ups: %u per cycle (%u before)\r\n", (unsigned)(wakeup_count), (unsigned)(CLOCK_BASE_WAKEUP_COUNT));
+        UNUSED(wakeup_count);
+
+        // The clock step is 64 us, the average over many messages is finer
+        if (mapper_msg_count != 0U)
+        {
+            LOG("Mapper: %u msg, %u bytes in %lu us\r\n", (unsigned)(mapper_msg_count), (unsigned)(mapper_byte_count), (unsigned long)(mapper_time_us));
+
+            mapper_time_us      = 0UL;
+            mapper_msg_count    = 0U;
+            mapper_byte_count   = 0U;
         }
     }
+    return;
 }
+#endif // NODE_DIAGNOSTICS
 
 void board_init_logging ()
 {
@@ -205,7 +556,7 @@ void board_init_logging ()
 
     // Init logger
     logger_config_t logger_config;
-    logger_config.write_byte_callback = uart_write_byte;
+    logger_config.write_byte_callback = board_write_log_byte;
 
     logger_init(&logger_config);
 
@@ -214,13 +565,24 @@ void board_init_logging ()
     return;
 }
 
+void board_write_log_byte (uint8_t byte)
+{
+    // The UART write blocks for a whole byte, which would outweigh the rest of the awake time
+    const uint8_t prev_activity = energy_meter_switch(BOARD_LOG_ACTIVITY);
+
+    uart_write_byte(byte);
+
+    energy_meter_switch(prev_activity);
+
+    return;
+}
+
 void board_init_strategy ()
 {
     node_id = NODE_B02;
 
     extra_strategy.init_callback            = board_b02_init;
     extra_strategy.process_callback         = board_b02_process;
-    extra_strategy.is_interrupt_callback    = board_b02_is_interrupt;
 
     return;
 }
@@ -262,87 +624,167 @@ void board_init_tcp_client ()
     config.netmask[2] = host_netmask[2];
     config.netmask[3] = host_netmask[3];
 
-    config.server_ip[0] = host_ip_address[0];
-    config.server_ip[1] = host_ip_address[1];
-    config.server_ip[2] = host_ip_address[2];
-    config.server_ip[3] = host_ip_address[3];
+#ifdef NODE_MACRAW_TRANSPORT
+    config.transport = TCP_CLIENT_TRANSPORT_MACRAW;
+#else
+    config.transport = TCP_CLIENT_TRANSPORT_TCP;
+#endif // NODE_MACRAW_TRANSPORT
+
+    config.ether_type = W5500_ETHER_TYPE;
 
-    config.server_port = host_port;
+    // Primary hub
+    config.server_array[0].ip[0] = host_ip_address[0];
+    config.server_array[0].ip[1] = host_ip_address[1];
+    config.server_array[0].ip[2] = host_ip_address[2];
+    config.server_array[0].ip[3] = host_ip_address[3];
+    config.server_array[0].port  = host_port;
+
+#ifdef NODE_BACKUP_HUB_IP
+    // Backup hub, the client fails over to it while the primary one is down
+    const uint8_t backup_hub_ip[] = { NODE_BACKUP_HUB_IP };
+
+    config.server_array[1].ip[0] = backup_hub_ip[0];
+    config.server_array[1].ip[1] = backup_hub_ip[1];
+    config.server_array[1].ip[2] = backup_hub_ip[2];
+    config.server_array[1].ip[3] = backup_hub_ip[3];
+    config.server_array[1].port  = NODE_BACKUP_HUB_PORT;
+
+    config.server_array_size = 2U;
+#else
+    config.server_array_size = 1U;
+#endif // NODE_BACKUP_HUB_IP
 
     if (tcp_client_init(&config, &error) != STD_SUCCESS)
     {
         LOG("%s\r\n", error.text);
     }
 
-    // Init INT_0 (W5500 interrupt)
-    int_0_config_t int_config;
-    int_config.edge                 = EDGE_0_FALLING;
-    int_config.is_pullup_enabled    = false;
-    int_config.int_0_callback       = board_int_0_ISR;
+    // Init message parser
+    node_mapper_stream_config_t stream_config;
+    stream_config.msg_callback  = board_process_message;
+    stream_config.node_mask     = NODE_MAPPER_NODE_BIT(node_id);
 
-    int_0_start(&int_config);
+    node_mapper_init_stream(&stream_config);
+
+    board_init_int_0();
 
     return;
 }
 
 
-void board_process_tcp_client ()
+void board_init_scheduler ()
 {
-    std_error_t error;
-    std_error_init(&error);
+    scheduler_config_t config;
+    size_t i = 0U;
+
+    // Timers go first, the events they post run the tasks in the next scheduler run
+    config.task_array[i].task_callback  = board_process_timers;
+    config.task_array[i].event_mask     = BOARD_TIMER_EVENT;
+    ++i;
+    config.task_array[i].task_callback  = board_process_tcp_client;
+    config.task_array[i].event_mask     = BOARD_W5500_EVENT | BOARD_NETWORK_EVENT | BOARD_MSG_EVENT;
+    ++i;
+    config.task_array[i].task_callback  = board_process_extra;
+    config.task_array[i].event_mask     = BOARD_EXTRA_EVENT | BOARD_STATE_EVENT;
+    ++i;
+    config.task_array[i].task_callback  = board_process_light_sensor;
+    config.task_array[i].event_mask     = BOARD_LIGHT_SENSOR_EVENT;
+    ++i;
+    config.task_array[i].task_callback  = board_process_led;
+    config.task_array[i].event_mask     = BOARD_STATE_EVENT;
+    ++i;
+    // The state is applied after all the tasks have seen it
+    config.task_array[i].task_callback  = board_process_state;
+    config.task_array[i].event_mask     = BOARD_STATE_EVENT;
+    ++i;
+    config.task_array_size = i;
+
+    scheduler_init(&config);
 
-    // Check interruptions
-    if (is_w5500_interrupt == true)
+    return;
+}
+
+void board_init_event_queue ()
+{
+    event_queue_config_t config;
+    config.time_callback = board_get_time_ms;
+
+    event_queue_init(&config);
+
+    return;
+}
+
+void board_init_timer_wheel ()
+{
+    timer_wheel_config_t config;
+    config.time_callback = board_get_time_ms;
+
+    timer_wheel_init(&config);
+
+    return;
+}
+
+void board_init_energy_meter ()
+{
+    energy_meter_config_t config;
+    config.time_callback        = board_get_awake_time_us;
+    config.peripheral_callback  = board_get_powered_peripherals;
+
+    for (size_t i = 0U; i < BOARD_ACTIVITY_COUNT; ++i)
     {
-        tcp_client_check_interrupts();
+        config.activity_current_uA_array[i] = MCU_ACTIVE_CURRENT_UA;
     }
+    config.activity_array_size = BOARD_ACTIVITY_COUNT;
+    config.excluded_activity_mask = (uint8_t)(1U << BOARD_LOG_ACTIVITY);
 
-    // Try to receive a message
-    tcp_client_receive_message(&tcp_msg);
-
-    if (tcp_msg.size != 0U)
+    // Peripherals by their PRR bits
+    for (size_t i = 0U; i < ARRAY_SIZE(config.peripheral_current_uA_array); ++i)
     {
-        LOG("In msg: %s\r\n", tcp_msg.buffer);
+        config.peripheral_current_uA_array[i] = 0U;
+    }
+    config.peripheral_current_uA_array[PRADC]       = 500U;
+    config.peripheral_current_uA_array[PRUSART0]    = 200U;
+    config.peripheral_current_uA_array[PRSPI]       = 380U;
+    config.peripheral_current_uA_array[PRTIM1]      = 310U;
+    config.peripheral_current_uA_array[PRTIM0]      = 100U;
+    config.peripheral_current_uA_array[PRTIM2]      = 370U;
+    config.peripheral_current_uA_array[PRTWI]       = 400U;
 
-        node_msg_t node_msg;
+    config.sleep_current_uA = MCU_SLEEP_CURRENT_UA;
+    config.base_current_uA  = BOARD_BASE_CURRENT_UA;
 
-        if (node_mapper_deserialize_message(tcp_msg.buffer, &node_msg, &error) != STD_SUCCESS)
-        {
-            LOG("%s\r\n", error.text);
-        }
-        else
-        {
-            bool is_msg_for_this_node = false;
+    energy_meter_init(&config);
 
-            for (size_t i = 0U; i < node_msg.header.dest_array_size; ++i)
-            {
-                if (node_id == node_msg.header.dest_array[i])
-                {
-                    is_msg_for_this_node = true;
+    return;
+}
 
-                    break;
-                }
-            }
 
-            if (is_msg_for_this_node == true)
-            {
-                if (node_msg.cmd_id == SET_LIGHT)
-                {
-                    if (node_msg.value_0 == (int32_t)(LIGHT_ON))
-                    {
-                        basic_state.is_enable_light_command = true;
-                    }
-                    else if (node_msg.value_0 == (int32_t)(LIGHT_OFF))
-                    {
-                        basic_state.is_disable_light_command = true;
-                    }
-                }
-                else if (node_msg.cmd_id == SET_MODE)
-                {
-                    basic_state.new_mode = (node_mode_id_t)(node_msg.value_0);
-                }
-            }
-        }
+void board_process_timers (scheduler_event_mask_t event_mask)
+{
+    UNUSED(event_mask);
+
+    // Only the expired timers are called back, they post events for the next loop pass
+    timer_wheel_process(board_get_time_ms());
+
+    return;
+}
+
+void board_process_tcp_client (scheduler_event_mask_t event_mask)
+{
+    const uint8_t prev_activity = energy_meter_switch(BOARD_TCP_ACTIVITY);
+
+    std_error_t error;
+    std_error_init(&error);
+
+    // Check interruptions
+    if ((event_mask & BOARD_W5500_EVENT) != 0U)
+    {
+        tcp_client_check_interrupts();
+
+#ifdef NODE_POWER_DOWN
+        // The W5500 has released its interrupt line
+        board_init_int_0();
+#endif // NODE_POWER_DOWN
     }
 
     // Try to connect or reconnect to a server
@@ -351,170 +793,1096 @@ void board_process_tcp_client ()
         LOG("%s\r\n", error.text);
     }
 
-    // Try to send messages
-    for (size_t i = 0U; i < ARRAY_SIZE(extra_state.send_msg_array); ++i)
+    // Every new connection starts with the default message format
+    const bool is_connected = tcp_client_is_connected();
+
+    if ((is_connected == true) && (is_tcp_client_connected == false))
     {
-        if (extra_state.send_msg_retry_count[i] < MESSAGE_SEND_RETRY_COUNT)
-        {
-            node_mapper_serialize_message(&extra_state.send_msg_array[i], tcp_msg.buffer, &tcp_msg.size);
+        tcp_msg_format = DEFAULT_MESSAGE_FORMAT;
 
-            LOG("Out msg: %s\r\n", tcp_msg.buffer);
+        node_mapper_reset_stream();
+    }
+    is_tcp_client_connected = is_connected;
 
-            if (tcp_client_send_message(&tcp_msg, &error) != STD_SUCCESS)
-            {
-                ++extra_state.send_msg_retry_count[i];
+    // Try to send messages, all pending ones are packed into as few segments as possible
+    board_send_messages();
 
-                LOG("%s\r\n", error.text);
-            }
-            else
-            {
-                extra_state.send_msg_retry_count[i] = MESSAGE_SEND_RETRY_COUNT;
-            }
-        }
-    }
-    extra_state.is_msg_to_send = false;
+    // Try to receive messages (they are processed as soon as they are parsed).
+    // Received commands are applied by the state tasks in the next loop pass, their acknowledgements are sent in the pass after it
+    tcp_client_receive_stream(board_receive_tcp_chunk);
+
+    energy_meter_switch(prev_activity);
 
     return;
 }
 
-void board_process_light_sensor ()
+coroutine_state_t board_send_messages ()
 {
-    static size_t prev_cycle_count = 0U;
+    COROUTINE_BEGIN(&send_coroutine);
+
+    // Messages queued from now on are left for the next pass
+    extra_state.is_msg_to_send = false;
 
-    if (basic_state.global_cycle_count < prev_cycle_count)
+    // The other tasks run while the W5500 is sending (until 'SIK_SENT' or the network timer)
+    for (send_msg_index = 0U; send_msg_index < ARRAY_SIZE(extra_state.send_msg_array);)
     {
-        prev_cycle_count = basic_state.global_cycle_count;
-    }
+        send_msg_index = board_send_message_batch(send_msg_index);
+
+        COROUTINE_WAIT_UNTIL(&send_coroutine, tcp_client_is_sending() == false);
 
-    const bool is_measuring_cycle = (basic_state.global_cycle_count - prev_cycle_count) > LIGHT_SENSOR_CYCLE_COUNT;
+        board_end_message_batch(board_get_sending_result());
+    }
 
-    if ((is_measuring_cycle == true) && (extra_state.is_light_on != true))
+    if ((extra_state.is_history_to_send == true) && (board_send_history() == STD_SUCCESS))
     {
-        board_deinit_timer1();
-        _delay_ms(500);
-        board_init_adc();
+        COROUTINE_WAIT_UNTIL(&send_coroutine, tcp_client_is_sending() == false);
 
-        uint16_t adc_value;
-        adc_read_single_shot(&adc_value);
+        board_end_history(board_get_sending_result());
+    }
 
-        board_deinit_adc();
+    COROUTINE_END(&send_coroutine);
+}
+
+size_t board_send_message_batch (size_t msg_index)
+{
+    std_error_t error;
+    std_error_init(&error);
 
-        if (basic_state.current_mode == SILENCE)
+    if (tcp_client_begin_message(&error) != STD_SUCCESS)
+    {
+        for (; msg_index < ARRAY_SIZE(extra_state.send_msg_array); ++msg_index)
         {
-            board_init_timer1(GPIO_A);
+            if (extra_state.send_msg_retry_count[msg_index] < MESSAGE_SEND_RETRY_COUNT)
+            {
+                ++extra_state.send_msg_retry_count[msg_index];
+
+                // Dropped
+                if (extra_state.send_msg_retry_count[msg_index] == MESSAGE_SEND_RETRY_COUNT)
+                {
+                    msg_cache_array[msg_index].raw_data_size = 0U;
+                }
+            }
         }
-        else
+        LOG("%s\r\n", error.text);
+
+        return msg_index;
+    }
+
+    size_t batch_msg_count = 0U;
+
+    for (; msg_index < ARRAY_SIZE(extra_state.send_msg_array); ++msg_index)
+    {
+        if (extra_state.send_msg_retry_count[msg_index] >= MESSAGE_SEND_RETRY_COUNT)
         {
-            board_init_timer1(GPIO_B);
+            continue;
         }
 
-        LOG("Light adc: %u\r\n", adc_value);
-        
-        //uint16_t adc_voltage = (uint16_t)((5.0F * ((float)adc_value / 1023.0F )) * 1000.0F);
-        //uint16_t resistance = (uint16_t)((10.0F * ((float)adc_value / 1023.0F )) * 1000.0F);
-        //LOG("ADC voltage %u mV\r\n", adc_voltage);
-        //LOG("Resistance %u Ohm\r\n", resistance);
+        if (tcp_client_get_message_size() >= MESSAGE_BATCH_MAX_SIZE)
+        {
+            break;
+        }
 
-        if (adc_value > LIGHT_SENSOR_DARK_THRESHOLD)
+        if ((batch_msg_count != 0U) && (tcp_msg_format == NODE_MAPPER_JSON_FORMAT))
         {
-            basic_state.is_dark = true;
+            tcp_client_append_message(MESSAGE_BATCH_SEPARATOR, sizeof(MESSAGE_BATCH_SEPARATOR) - 1U);
         }
-        else
+
+        if (board_append_message(msg_index, &error) != STD_SUCCESS)
         {
-            basic_state.is_dark = false;
+            // Message will never fit, do not retry it
+            extra_state.send_msg_retry_count[msg_index] = MESSAGE_SEND_RETRY_COUNT;
+
+            LOG("%s\r\n", error.text);
+
+            continue;
         }
+        is_in_batch_array[msg_index]        = true;
+        batch_retry_count_array[msg_index]  = extra_state.send_msg_retry_count[msg_index];
 
-        prev_cycle_count = basic_state.global_cycle_count;
+        extra_state.send_msg_retry_count[msg_index] = MESSAGE_SEND_RETRY_COUNT;
+        ++batch_msg_count;
     }
-    return;
-}
 
-void board_process_led ()
-{
-    if (basic_state.current_mode != basic_state.new_mode)
+    if (batch_msg_count == 0U)
     {
-        if (basic_state.new_mode == GUARD)
-        {
-            board_deinit_timer1();
-            board_init_timer1(GPIO_B);
-        }
-        else
-        {
-            board_deinit_timer1();
-            board_init_timer1(GPIO_A);
-        }
+        tcp_client_abort_message();
+
+        return msg_index;
     }
-    return;
-}
 
+    LOG("Out msg: %u in %u bytes\r\n", (unsigned)(batch_msg_count), (unsigned)(tcp_client_get_message_size()));
 
-void board_timer1_overflow_ISR ()
-{
-    ++timer1_overflow_count; // 1 cycle = ~8 seconds
+    // One SEND for the whole batch, so the messages succeed or fail together
+    if (tcp_client_end_message(&error) != STD_SUCCESS)
+    {
+        LOG("%s\r\n", error.text);
 
-    return;
+        board_end_message_batch(STD_FAILURE);
+    }
+    return msg_index;
 }
 
-void board_int_0_ISR ()
+void board_end_message_batch (int exit_code)
 {
-    is_int_0_interrupt = true;
+    for (size_t i = 0U; i < ARRAY_SIZE(is_in_batch_array); ++i)
+    {
+        if (is_in_batch_array[i] == true)
+        {
+            is_in_batch_array[i] = false;
+
+            // A message queued again meanwhile is left as it is
+            if ((exit_code != STD_SUCCESS) && (extra_state.send_msg_retry_count[i] == MESSAGE_SEND_RETRY_COUNT))
+            {
+                extra_state.send_msg_retry_count[i] = batch_retry_count_array[i] + 1U;
+            }
 
+            // Sent or dropped
+            if (extra_state.send_msg_retry_count[i] >= MESSAGE_SEND_RETRY_COUNT)
+            {
+                msg_cache_array[i].raw_data_size = 0U;
+            }
+        }
+    }
     return;
 }
 
-
-void w5500_spi_select ()
+int board_append_message (size_t msg_index, std_error_t * const error)
 {
-    W5500_PORT_CS &= ~(1 << W5500_PIN_CS);
+    board_msg_cache_t * const msg_cache = &msg_cache_array[msg_index];
 
-    return;
-}
+    // A retry goes straight from the cache, a rewritten message is queued with a zero retry count and serialized again
+    if ((tcp_msg_format == NODE_MAPPER_BINARY_FORMAT) && (extra_state.send_msg_retry_count[msg_index] != 0U) && (msg_cache->raw_data_size != 0U))
+    {
+        tcp_client_append_message(msg_cache->raw_data, msg_cache->raw_data_size);
 
-void w5500_spi_unselect ()
-{
-    W5500_PORT_CS |= (1 << W5500_PIN_CS);
+        return STD_SUCCESS;
+    }
 
-    return;
-}
+    msg_cache->raw_data_size = 0U;
 
+    if (tcp_msg_format == NODE_MAPPER_BINARY_FORMAT)
+    {
+        filling_msg_cache = msg_cache;
+    }
 
-void board_init_timer1 (timer_1_gpio_t gpio)
-{
-    power_timer1_enable();
+    // Serialized chunks go straight into the W5500 TX buffer and into the cache
+    const uint8_t prev_activity = energy_meter_switch(BOARD_MAPPER_ACTIVITY);
+#ifdef NODE_DIAGNOSTICS
+    const uint32_t start_time_us = board_get_awake_time_us();
+#endif // NODE_DIAGNOSTICS
 
-    timer_1_config_t timer_1_config;
-    timer_1_config.mode                 = TIMER_1_PWM_MODE;
-    timer_1_config.prescaler            = TIMER_1_PRESCALER_1024;
-    timer_1_config.overflow_callback    = board_timer1_overflow_ISR;
+    const int exit_code = node_mapper_serialize_stream(&extra_state.send_msg_array[msg_index], tcp_msg_format, board_append_message_chunk, error);
 
-    timer_1_config.period_a = 3000U;
-    timer_1_config.period_b = 3000U;
-    timer_1_config.compare_a_callback = NULL;
-    timer_1_config.compare_b_callback = NULL;
+#ifdef NODE_DIAGNOSTICS
+    mapper_time_us += board_get_awake_time_us() - start_time_us;
+    ++mapper_msg_count;
+#endif // NODE_DIAGNOSTICS
+    energy_meter_switch(prev_activity);
 
-    timer_1_config.top = 50782U; // ~7.5 sec (65535 - max ~8 sec)
-    timer_1_config.is_gpio_a_enabled = false;
-    timer_1_config.is_gpio_b_enabled = false;
+    filling_msg_cache = NULL;
 
-    if (gpio == GPIO_A)
-    {
-        timer_1_config.is_gpio_a_enabled = true;
-    }
-    else if (gpio == GPIO_B)
+    if (exit_code != STD_SUCCESS)
     {
-        timer_1_config.is_gpio_b_enabled = true;
+        msg_cache->raw_data_size = 0U;
     }
-
-    timer_1_start(&timer_1_config);
-
-    return;
+    return exit_code;
 }
 
-void board_deinit_timer1 ()
+void board_append_message_chunk (const char *chunk, size_t chunk_size)
 {
-    timer_1_stop();
+    tcp_client_append_message(chunk, chunk_size);
+#ifdef NODE_DIAGNOSTICS
+    mapper_byte_count += (uint16_t)(chunk_size);
+#endif // NODE_DIAGNOSTICS
 
-    power_timer1_disable();
+    if (filling_msg_cache != NULL)
+    {
+        if ((filling_msg_cache->raw_data_size + chunk_size) <= ARRAY_SIZE(filling_msg_cache->raw_data))
+        {
+            memcpy(&filling_msg_cache->raw_data[filling_msg_cache->raw_data_size], chunk, chunk_size);
+            filling_msg_cache->raw_data_size += (uint8_t)(chunk_size);
+        }
+        else
+        {
+            // Too long, it is serialized again on retry
+            filling_msg_cache->raw_data_size = 0U;
+            filling_msg_cache = NULL;
+        }
+    }
+    return;
+}
+
+int board_send_history ()
+{
+    std_error_t error;
+    std_error_init(&error);
+
+    // On failure the history is kept for the next pass, new samples overwrite the oldest ones meanwhile
+    if (tcp_client_begin_message(&error) != STD_SUCCESS)
+    {
+        LOG("%s\r\n", error.text);
+
+        return STD_FAILURE;
+    }
+
+    const uint8_t prev_activity = energy_meter_switch(BOARD_MAPPER_ACTIVITY);
+
+    const int exit_code = node_mapper_serialize_history_stream(&extra_state.history_msg, &extra_state.history, basic_state.uptime_cycle_count, tcp_msg_format, tcp_client_append_message, &error);
+
+    energy_meter_switch(prev_activity);
+
+    if (exit_code != STD_SUCCESS)
+    {
+        tcp_client_abort_message();
+
+        // History will never fit, do not retry it
+        node_mapper_clear_history(&extra_state.history);
+        extra_state.is_history_to_send = false;
+
+        LOG("%s\r\n", error.text);
+
+        return STD_FAILURE;
+    }
+
+    LOG("Out history: %u samples in %u bytes\r\n", (unsigned)(extra_state.history.size), (unsigned)(tcp_client_get_message_size()));
+
+    if (tcp_client_end_message(&error) != STD_SUCCESS)
+    {
+        LOG("%s\r\n", error.text);
+
+        return STD_FAILURE;
+    }
+    batch_sample_count = extra_state.history.size;
+
+    return STD_SUCCESS;
+}
+
+void board_end_history (int exit_code)
+{
+    // Samples taken while the history was being sent go with the next one
+    if (exit_code == STD_SUCCESS)
+    {
+        node_mapper_drop_samples(&extra_state.history, batch_sample_count);
+        extra_state.is_history_to_send = false;
+    }
+    return;
+}
+
+int board_get_sending_result ()
+{
+    std_error_t error;
+    std_error_init(&error);
+
+    const int exit_code = tcp_client_get_sending_result(&error);
+
+    if (exit_code != STD_SUCCESS)
+    {
+        LOG("%s\r\n", error.text);
+    }
+    return exit_code;
+}
+
+void board_receive_tcp_chunk (const char *chunk, size_t chunk_size)
+{
+    std_error_t error;
+    std_error_init(&error);
+
+    // Commands are applied as they are parsed, which is counted in
+    const uint8_t prev_activity = energy_meter_switch(BOARD_MAPPER_ACTIVITY);
+
+    if (node_mapper_parse_stream(chunk, chunk_size, &error) != STD_SUCCESS)
+    {
+        LOG("%s\r\n", error.text);
+    }
+    energy_meter_switch(prev_activity);
+
+    return;
+}
+
+void board_process_message (node_msg_t const * const node_msg, node_mapper_format_t format, uint16_t request_id)
+{
+    LOG("In msg: %u cmd, %u req\r\n", (unsigned)(node_msg->cmd_id), (unsigned)(request_id));
+
+    // The hub selects the message format for the connection by the format it talks
+    tcp_msg_format = format;
+
+    // Messages for other nodes are dropped by the mapper
+    if (node_msg->cmd_id == SET_LIGHT)
+    {
+        if (node_msg->value_0 == (int32_t)(LIGHT_ON))
+        {
+            basic_state.is_enable_light_command = true;
+        }
+        else if (node_msg->value_0 == (int32_t)(LIGHT_OFF))
+        {
+            basic_state.is_disable_light_command = true;
+        }
+    }
+    else if (node_msg->cmd_id == SET_MODE)
+    {
+        basic_state.new_mode = (node_mode_id_t)(node_msg->value_0);
+    }
+    else
+    {
+        return;
+    }
+    scheduler_post_event(BOARD_STATE_EVENT);
+
+    if (request_id != NODE_MAPPER_NO_REQUEST_ID)
+    {
+        board_hold_ack(node_msg, request_id);
+    }
+    return;
+}
+
+void board_hold_ack (node_msg_t const * const node_msg, uint16_t request_id)
+{
+    if (held_ack_count < ARRAY_SIZE(held_ack_array))
+    {
+        held_ack_array[held_ack_count].dest_id      = node_msg->header.source;
+        held_ack_array[held_ack_count].cmd_id       = node_msg->cmd_id;
+        held_ack_array[held_ack_count].request_id   = request_id;
+
+        ++held_ack_count;
+    }
+    else
+    {
+        LOG("No ACK slot\r\n");
+    }
+    return;
+}
+
+void board_queue_ack (board_ack_t const * const ack)
+{
+    // Called by the state task once the command is applied, the message is sent in the next loop pass
+    for (size_t i = ACK_MSG; i < (ACK_MSG + BOARD_ACK_MSG_COUNT); ++i)
+    {
+        if (extra_state.send_msg_retry_count[i] >= MESSAGE_SEND_RETRY_COUNT)
+        {
+            extra_state.send_msg_array[i].header.source          = node_id;
+            extra_state.send_msg_array[i].header.dest_array[0]   = ack->dest_id;
+            extra_state.send_msg_array[i].header.dest_array_size = 1U;
+
+            extra_state.send_msg_array[i].cmd_id    = (node_command_id_t)(NODE_MAPPER_ACK_CMD_ID);
+            extra_state.send_msg_array[i].value_0   = NODE_MAPPER_PACK_ACK(ack->cmd_id, ack->request_id);
+
+            extra_state.send_msg_retry_count[i] = 0U;
+
+            extra_state.is_msg_to_send = true;
+
+            return;
+        }
+    }
+    LOG("No ACK slot\r\n");
+
+    return;
+}
+
+void board_process_extra (scheduler_event_mask_t event_mask)
+{
+    UNUSED(event_mask);
+
+    const uint8_t prev_activity = energy_meter_switch(BOARD_EXTRA_ACTIVITY);
+
+    extra_strategy.process_callback(&basic_state, &extra_state);
+
+    energy_meter_switch(prev_activity);
+
+    return;
+}
+
+void board_process_light_sensor (scheduler_event_mask_t event_mask)
+{
+    UNUSED(event_mask);
+
+    const uint8_t prev_activity = energy_meter_switch(BOARD_ADC_ACTIVITY);
+
+    board_measure_light();
+
+    energy_meter_switch(prev_activity);
+
+    return;
+}
+
+coroutine_state_t board_measure_light ()
+{
+    COROUTINE_BEGIN(&light_sensor_coroutine);
+
+    if (extra_state.is_light_on == true)
+    {
+        timer_wheel_start(&light_sensor_timer, LIGHT_SENSOR_RETRY_MS, LIGHT_SENSOR_PERIOD_MS);
+    }
+    else
+    {
+        // The mode LED keeps on, the conversion is started in its off-phase and ends in the interrupt
+#ifndef NODE_POWER_DOWN
+        board_init_adc();
+#endif // NODE_POWER_DOWN
+        is_light_conversion_requested = true;
+
+        COROUTINE_WAIT_UNTIL(&light_sensor_coroutine, (is_light_conversion_requested == false) && (is_light_conversion_running == false));
+
+        board_deinit_adc();
+
+        const uint16_t adc_value = light_adc_value;
+
+        LOG("Light adc: %u\r\n", adc_value);
+        
+        //uint16_t adc_voltage = (uint16_t)((5.0F * ((float)adc_value / 1023.0F )) * 1000.0F);
+        //uint16_t resistance = (uint16_t)((10.0F * ((float)adc_value / 1023.0F )) * 1000.0F);
+        //LOG("ADC voltage %u mV\r\n", adc_voltage);
+        //LOG("Resistance %u Ohm\r\n", resistance);
+
+        const bool is_dark = (adc_value > LIGHT_SENSOR_DARK_THRESHOLD);
+
+        if (is_dark != basic_state.is_dark)
+        {
+            basic_state.is_dark = is_dark;
+
+            scheduler_post_event(BOARD_STATE_EVENT);
+        }
+    }
+
+    COROUTINE_END(&light_sensor_coroutine);
+}
+
+void board_process_led (scheduler_event_mask_t event_mask)
+{
+    UNUSED(event_mask);
+
+    if (basic_state.current_mode != basic_state.new_mode)
+    {
+        if (basic_state.new_mode == GUARD)
+        {
+            board_switch_led(GPIO_B);
+        }
+        else
+        {
+            board_switch_led(GPIO_A);
+        }
+    }
+    return;
+}
+
+void board_process_state (scheduler_event_mask_t event_mask)
+{
+    UNUSED(event_mask);
+
+    basic_state.current_mode = basic_state.new_mode;
+    basic_state.is_enable_light_command = false;
+    basic_state.is_disable_light_command = false;
+
+    // The other tasks have applied the commands of this state
+    for (size_t i = 0U; i < held_ack_count; ++i)
+    {
+        board_queue_ack(&held_ack_array[i]);
+    }
+    held_ack_count = 0U;
+
+    return;
+}
+
+void board_light_sensor_timer_callback ()
+{
+    scheduler_post_event(BOARD_LIGHT_SENSOR_EVENT);
+
+    return;
+}
+
+void board_start_light_conversion ()
+{
+    // The flags change in this order, so the light sensor never sees both of them cleared before the end
+    is_light_conversion_running     = true;
+    is_light_conversion_requested   = false;
+
+    adc_start_conversion();
+
+    return;
+}
+
+void board_adc_ISR (uint16_t adc_value)
+{
+    light_adc_value             = adc_value;
+    is_light_conversion_running = false;
+
+    scheduler_post_event(BOARD_LIGHT_SENSOR_EVENT);
+
+    return;
+}
+
+#ifdef NODE_POWER_DOWN
+void board_light_sensor_wait_timer_callback ()
+{
+    // The ADC is only powered for the conversion
+    board_init_adc();
+    board_start_light_conversion();
+
+    return;
+}
+#else
+void board_timer1_top_ISR ()
+{
+    // A clock cycle starts at TOP, the counter turns down and sets the BOTTOM flag in the middle of the cycle
+    timer_1_clear_overflow();
+
+    const uint32_t ticks = clock_tick_fraction + CLOCK_CYCLE_TICKS;
+
+    clock_tick_fraction = (uint16_t)(ticks % CLOCK_STEP_TICKS);
+    clock_time_ms += (ticks / CLOCK_STEP_TICKS) * CLOCK_STEP_MS;
+    is_clock_starting = false;
+
+    ++clock_wakeup_count;
+
+    board_end_clock_cycle();
+    board_check_clock_wake(board_get_time_ms());
+    board_program_clock();
+
+    // The LED has been off for ~3 sec and stays off for as long
+    if (is_light_conversion_requested == true)
+    {
+        board_start_light_conversion();
+    }
+
+    // Once per cycle, within the hang timeout: a hung main loop does not disarm the interrupt again,
+    // so its hang is recorded. A hang with interrupts disabled never gets here and is reset without a record
+    watchdog_rearm();
+
+    return;
+}
+#endif // NODE_POWER_DOWN
+
+void board_network_timer_callback ()
+{
+    scheduler_post_event(BOARD_NETWORK_EVENT);
+
+    return;
+}
+
+void board_energy_timer_callback ()
+{
+    const uint32_t time_ms = board_get_time_ms();
+
+    energy_meter_report_t report;
+    energy_meter_report(time_ms - energy_report_time_ms, &report);
+
+    energy_report_time_ms = time_ms;
+
+    // Saturated, the report is sent to the hub in every build
+    uint32_t current_mA_x100 = report.average_current_uA / 10UL;
+
+    if (current_mA_x100 > UINT16_MAX)
+    {
+        current_mA_x100 = UINT16_MAX;
+    }
+
+    uint32_t awake_permille = 1000UL;
+
+    if ((report.period_ms != 0UL) && ((report.awake_time_us / report.period_ms) < awake_permille))
+    {
+        awake_permille = report.awake_time_us / report.period_ms;
+    }
+
+    extra_state.send_msg_array[ENERGY_MSG].header.source          = node_id;
+    extra_state.send_msg_array[ENERGY_MSG].header.dest_array[0]   = NODE_B01;
+    extra_state.send_msg_array[ENERGY_MSG].header.dest_array_size = 1U;
+
+    extra_state.send_msg_array[ENERGY_MSG].cmd_id   = (node_command_id_t)(NODE_MAPPER_ENERGY_CMD_ID);
+    extra_state.send_msg_array[ENERGY_MSG].value_0  = NODE_MAPPER_PACK_ENERGY(current_mA_x100, awake_permille);
+
+    extra_state.send_msg_retry_count[ENERGY_MSG] = 0U;
+
+    extra_state.is_msg_to_send = true;
+
+    LOG("Energy: %lu uAh per hour, awake %lu us in %lu ms\r\n", (unsigned long)(report.average_current_uA), (unsigned long)(report.awake_time_us), (unsigned long)(report.period_ms));
+
+    for (size_t i = 0U; i < BOARD_ACTIVITY_COUNT; ++i)
+    {
+        LOG("Activity %u: %lu us\r\n", (unsigned)(i), (unsigned long)(report.activity_time_us_array[i]));
+    }
+
+    for (size_t i = 0U; i < ARRAY_SIZE(report.peripheral_time_us_array); ++i)
+    {
+        LOG("PRR bit %u: %lu us\r\n", (unsigned)(i), (unsigned long)(report.peripheral_time_us_array[i]));
+    }
+    return;
+}
+
+#ifdef NODE_POWER_DOWN
+void board_led_timer_callback ()
+{
+    is_led_on = !is_led_on;
+
+    const uint8_t led_pin = (led_gpio == GPIO_A) ? LED_PIN_A : LED_PIN_B;
+
+    if (is_led_on == true)
+    {
+        LED_PORT |= (1 << led_pin);
+        timer_wheel_start(&led_timer, LED_ON_TIME_MS, 0UL);
+    }
+    else
+    {
+        LED_PORT &= ~(1 << led_pin);
+        timer_wheel_start(&led_timer, LED_OFF_TIME_MS, 0UL);
+
+        if (is_light_conversion_requested == true)
+        {
+            timer_wheel_start(&light_sensor_wait_timer, LIGHT_SENSOR_SETTLE_TIME_MS, 0UL);
+        }
+    }
+    return;
+}
+#endif // NODE_POWER_DOWN
+
+
+#ifdef NODE_POWER_DOWN
+void board_watchdog_ISR ()
+{
+    const uint16_t tick_ms = watchdog_get_timeout_ms(clock_timeout);
+
+    board_tick_clock(tick_ms);
+    board_check_clock_wake(clock_time_ms);
+    board_program_clock();
+
+    watchdog_unfed_time_ms += tick_ms;
+
+    if (watchdog_unfed_time_ms >= WATCHDOG_HANG_TIME_MS)
+    {
+        // Left disarmed, the next tick resets the MCU
+        board_record_hang();
+    }
+    else
+    {
+        watchdog_rearm();
+    }
+    return;
+}
+
+void board_timer0_compare_ISR ()
+{
+    awake_clock_time_us += AWAKE_CLOCK_TICKS * CLOCK_TICK_US;
+
+    return;
+}
+#else
+void board_watchdog_hang_ISR ()
+{
+    // The main loop has not fed the watchdog for WATCHDOG_HANG_TIMEOUT, the interrupt is disarmed by now,
+    // so the next timeout resets the MCU
+    board_record_hang();
+
+    watchdog_set_timeout(WATCHDOG_TIMEOUT_16MS);
+
+    return;
+}
+
+void board_timer2_compare_ISR ()
+{
+    // One-shot, the deadline has come ('board_program_clock' stops the timer)
+    ++clock_wakeup_count;
+
+    board_check_clock_wake(board_get_time_ms());
+    board_program_clock();
+
+    return;
+}
+#endif // NODE_POWER_DOWN
+
+#ifdef NODE_POWER_DOWN
+void board_tick_clock (uint32_t tick_ms)
+{
+    clock_time_ms += tick_ms;
+    clock_cycle_time_ms += tick_ms;
+
+    ++clock_wakeup_count;
+
+    if (clock_cycle_time_ms >= CLOCK_CYCLE_MS)
+    {
+        clock_cycle_time_ms -= CLOCK_CYCLE_MS;
+
+        board_end_clock_cycle();
+    }
+    return;
+}
+#else
+uint32_t board_get_cycle_ticks ()
+{
+    // The flags go first, the counter read after them is never behind them
+    const bool is_top_pending       = timer_1_is_top_pending();
+    const bool is_overflow_pending  = timer_1_is_overflow_pending();
+    const uint16_t counter          = timer_1_get_counter();
+
+    if (is_top_pending == true)
+    {
+        // The next cycle has started, its interrupt is held off
+        return CLOCK_CYCLE_TICKS + (uint32_t)(CLOCK_TIMER1_TOP - counter);
+    }
+
+    if ((is_overflow_pending == true) || (is_clock_starting == true))
+    {
+        // Back up from BOTTOM
+        return (uint32_t)(CLOCK_TIMER1_TOP) + counter;
+    }
+    return (uint32_t)(CLOCK_TIMER1_TOP - counter);
+}
+#endif // NODE_POWER_DOWN
+
+void board_end_clock_cycle ()
+{
+    ++clock_cycle_count;
+
+    clock_cycle_wakeup_count    = clock_wakeup_count;
+    clock_wakeup_count          = 0U;
+
+    return;
+}
+
+void board_check_clock_wake (uint32_t time_ms)
+{
+    // A long tick may step over the wake time
+    if ((is_clock_wake_time_set == true) && ((int32_t)(time_ms - clock_wake_time_ms) >= 0L))
+    {
+        is_clock_wake_time_set = false;
+
+        scheduler_post_event(BOARD_TIMER_EVENT);
+    }
+    return;
+}
+
+void board_program_clock ()
+{
+#ifdef NODE_POWER_DOWN
+    watchdog_timeout_t timeout = CLOCK_BASE_TIMEOUT;
+
+    if (is_clock_wake_time_set == true)
+    {
+        const int32_t delay_ms = (int32_t)(clock_wake_time_ms - clock_time_ms);
+
+        // The shortest timeout, which reaches the deadline, unless it overshoots too far
+        timeout = WATCHDOG_TIMEOUT_16MS;
+
+        while ((timeout < CLOCK_MAX_TIMEOUT) && ((int32_t)(watchdog_get_timeout_ms(timeout)) < delay_ms))
+        {
+            ++timeout;
+        }
+
+        if ((timeout > WATCHDOG_TIMEOUT_16MS) && ((int32_t)(watchdog_get_timeout_ms(timeout)) > (delay_ms + (int32_t)(CLOCK_WAKE_TOLERANCE_MS))))
+        {
+            --timeout;
+        }
+    }
+
+    if (timeout != clock_timeout)
+    {
+        clock_timeout = timeout;
+
+        watchdog_set_timeout(clock_timeout);
+    }
+#else
+    board_stop_clock_alarm();
+
+    if (is_clock_wake_time_set == true)
+    {
+        const int32_t delay_ms = (int32_t)(clock_wake_time_ms - board_get_time_ms());
+
+        if ((delay_ms > 0L) && (delay_ms <= CLOCK_ALARM_MAX_MS))
+        {
+            // Rounded up and one tick more, the prescaler is not reset, so the first tick may come early
+            const uint32_t ticks = ((((uint32_t)(delay_ms) * CLOCK_STEP_TICKS) + CLOCK_STEP_MS - 1UL) / CLOCK_STEP_MS) + 1UL;
+
+            board_start_clock_alarm((uint8_t)(ticks));
+        }
+    }
+#endif // NODE_POWER_DOWN
+
+    return;
+}
+
+uint32_t board_get_time_ms ()
+{
+    uint32_t time_ms;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        time_ms = clock_time_ms;
+
+#ifndef NODE_POWER_DOWN
+        // The part of the current cycle, the watchdog counter can not be read in power-down
+        const uint32_t ticks = clock_tick_fraction + board_get_cycle_ticks();
+
+        time_ms += (ticks * CLOCK_STEP_MS) / CLOCK_STEP_TICKS;
+#endif // NODE_POWER_DOWN
+    }
+    return time_ms;
+}
+
+uint32_t board_get_awake_time_us ()
+{
+    uint32_t time_us;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+#ifdef NODE_POWER_DOWN
+        // Timer0 stops in power-down, so only the time awake is counted
+        time_us = awake_clock_time_us;
+
+        uint16_t ticks = timer_0_get_counter();
+
+        if (timer_0_is_compare_pending() == true)
+        {
+            ticks = AWAKE_CLOCK_TICKS + timer_0_get_counter();
+        }
+        time_us += (uint32_t)(ticks) * CLOCK_TICK_US;
+#else
+        // The wall time wraps around (~71 min), the accounts only take the differences
+        time_us = clock_time_ms * 1000UL;
+        time_us += (clock_tick_fraction + board_get_cycle_ticks()) * CLOCK_TICK_US;
+#endif // NODE_POWER_DOWN
+    }
+    return time_us;
+}
+
+uint8_t board_get_powered_peripherals ()
+{
+    // The bits of the peripherals put out by 'power_*_disable' are set
+    return (uint8_t)(~PRR);
+}
+
+void board_record_hang ()
+{
+    // The interrupt returns to the hung code, the reset follows
+    hang_record.address     = watchdog_get_interrupted_address();
+    hang_record.stack_size  = (uint8_t)(watchdog_copy_interrupted_stack(hang_record.stack_array, ARRAY_SIZE(hang_record.stack_array)));
+    hang_record.magic       = HANG_RECORD_MAGIC;
+
+    return;
+}
+
+void board_report_hang (uint8_t reset_flags)
+{
+    if (((reset_flags & (1 << WDRF)) != 0U) && (hang_record.magic == HANG_RECORD_MAGIC))
+    {
+        // Sent to the hub in every build, as the energy report
+        extra_state.send_msg_array[HANG_MSG].header.source          = node_id;
+        extra_state.send_msg_array[HANG_MSG].header.dest_array[0]   = NODE_B01;
+        extra_state.send_msg_array[HANG_MSG].header.dest_array_size = 1U;
+
+        extra_state.send_msg_array[HANG_MSG].cmd_id   = (node_command_id_t)(NODE_MAPPER_HANG_CMD_ID);
+        extra_state.send_msg_array[HANG_MSG].value_0  = NODE_MAPPER_PACK_HANG(hang_record.address);
+
+        extra_state.send_msg_retry_count[HANG_MSG] = 0U;
+
+        extra_state.is_msg_to_send = true;
+
+        // The callers are among the stack bytes, match them against the listing
+        LOG("Hang at 0x%04x, stack:", (unsigned)(hang_record.address));
+
+        for (size_t i = 0U; (i < hang_record.stack_size) && (i < ARRAY_SIZE(hang_record.stack_array)); ++i)
+        {
+            LOG(" %02x", (unsigned)(hang_record.stack_array[i]));
+        }
+        LOG("\r\n");
+    }
+    hang_record.magic = 0U;
+
+    return;
+}
+
+void board_feed_watchdog ()
+{
+#ifdef NODE_POWER_DOWN
+    // The watchdog is the clock here, 'wdt_reset' would hold its tick back
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        watchdog_unfed_time_ms = 0U;
+
+        watchdog_rearm();
+    }
+#else
+    wdt_reset();
+
+    // A reset-only watchdog while the main loop runs, the Timer1 cycle arms the interrupt again
+    watchdog_disarm();
+#endif // NODE_POWER_DOWN
+
+    return;
+}
+
+void board_int_0_ISR ()
+{
+#ifdef NODE_POWER_DOWN
+    // The low level holds until the W5500 interrupts are cleared
+    int_0_stop();
+#endif // NODE_POWER_DOWN
+
+    scheduler_post_event(BOARD_W5500_EVENT);
+
+    return;
+}
+
+
+void w5500_spi_select ()
+{
+    W5500_PORT_CS &= ~(1 << W5500_PIN_CS);
+
+    return;
+}
+
+void w5500_spi_unselect ()
+{
+    W5500_PORT_CS |= (1 << W5500_PIN_CS);
+
+    return;
+}
+
+
+void board_start_led (timer_1_gpio_t gpio)
+{
+#ifdef NODE_POWER_DOWN
+    led_gpio    = gpio;
+    is_led_on   = false;
+
+    LED_DDR |= (1 << ((gpio == GPIO_A) ? LED_PIN_A : LED_PIN_B));
+
+    timer_wheel_start(&led_timer, 0UL, 0UL);
+#else
+    board_init_timer1(gpio);
+#endif // NODE_POWER_DOWN
+
+    return;
+}
+
+void board_switch_led (timer_1_gpio_t gpio)
+{
+    // The LED goes on with its phase, so the light measurement stays in the off-phase
+#ifdef NODE_POWER_DOWN
+    led_gpio = gpio;
+
+    const uint8_t led_pin = (gpio == GPIO_A) ? LED_PIN_A : LED_PIN_B;
+
+    LED_PORT &= ~((1 << LED_PIN_A) | (1 << LED_PIN_B));
+    LED_DDR |= (1 << led_pin);
+
+    if (is_led_on == true)
+    {
+        LED_PORT |= (1 << led_pin);
+    }
+#else
+    timer_1_set_gpio(gpio == GPIO_A, gpio == GPIO_B);
+#endif // NODE_POWER_DOWN
+
+    return;
+}
+
+void board_init_watchdog ()
+{
+    watchdog_config_t watchdog_config;
+
+#ifdef NODE_POWER_DOWN
+    watchdog_unfed_time_ms  = 0U;
+    clock_timeout           = CLOCK_BASE_TIMEOUT;
+
+    watchdog_config.timeout             = clock_timeout;
+    watchdog_config.interrupt_callback  = board_watchdog_ISR;
+#else
+    // The interrupt records a hang, the reset follows it
+    watchdog_config.timeout             = WATCHDOG_HANG_TIMEOUT;
+    watchdog_config.interrupt_callback  = board_watchdog_hang_ISR;
+#endif // NODE_POWER_DOWN
+
+    watchdog_start(&watchdog_config);
+
+    return;
+}
+
+#ifdef NODE_POWER_DOWN
+
+void board_init_timer0 ()
+{
+    power_timer0_enable();
+
+    awake_clock_time_us = 0UL;
+
+    timer_0_config_t timer_0_config;
+    timer_0_config.timer_0_callback = board_timer0_compare_ISR;
+    timer_0_config.prescaler        = TIMER_0_PRESCALER_1024;
+    timer_0_config.ticks            = (uint8_t)(AWAKE_CLOCK_TICKS - 1U);
+
+    timer_0_start_in_ctc_mode(&timer_0_config);
+
+    return;
+}
+#else
+void board_init_timer1 (timer_1_gpio_t gpio)
+{
+    power_timer1_enable();
+
+    timer_1_config_t timer_1_config;
+    timer_1_config.mode                 = TIMER_1_PWM_MODE;
+    timer_1_config.prescaler            = TIMER_1_PRESCALER_1024;
+    timer_1_config.overflow_callback    = NULL; // The clock takes the BOTTOM flag, the cycles are counted at TOP
+
+    timer_1_config.period_a = 3000U;
+    timer_1_config.period_b = 3000U;
+    timer_1_config.compare_a_callback = NULL;
+    timer_1_config.compare_b_callback = NULL;
+
+    timer_1_config.top = CLOCK_TIMER1_TOP;
+    timer_1_config.is_gpio_a_enabled = false;
+    timer_1_config.is_gpio_b_enabled = false;
+    timer_1_config.top_callback = board_timer1_top_ISR;
+
+    if (gpio == GPIO_A)
+    {
+        timer_1_config.is_gpio_a_enabled = true;
+    }
+    else if (gpio == GPIO_B)
+    {
+        timer_1_config.is_gpio_b_enabled = true;
+    }
+
+    timer_1_start(&timer_1_config);
+
+    return;
+}
+
+void board_start_clock_alarm (uint8_t ticks)
+{
+    power_timer2_enable();
+
+    // 16 MHz / 1024 = 64 us per tick, the compare interrupt comes once the counter reaches 'ticks'
+    timer_2_config_t timer_2_config;
+    timer_2_config.timer_2_callback = board_timer2_compare_ISR;
+    timer_2_config.prescaler        = TIMER_2_PRESCALER_1024;
+    timer_2_config.ticks            = ticks;
+
+    timer_2_start_in_ctc_mode(&timer_2_config);
+
+    return;
+}
+
+void board_stop_clock_alarm ()
+{
+    timer_2_stop();
+
+    power_timer2_disable();
+
+    return;
+}
+#endif // NODE_POWER_DOWN
+
+void board_init_int_0 ()
+{
+    // Init INT_0 (W5500 interrupt)
+    int_0_config_t int_config;
+#ifdef NODE_POWER_DOWN
+    int_config.edge                 = EDGE_0_LOW_LEVEL; // Only the level wakes up from power-down
+#else
+    int_config.edge                 = EDGE_0_FALLING;
+#endif // NODE_POWER_DOWN
+    int_config.is_pullup_enabled    = false;
+    int_config.int_0_callback       = board_int_0_ISR;
+
+    int_0_start(&int_config);
 
     return;
 }
@@ -547,6 +1915,7 @@ void board_init_adc ()
     adc_config_t adc_config;
     adc_config.input        = ADC_INPUT_0;
     adc_config.ref_voltage  = ADC_REF_VOLTAGE_AVCC;
+    adc_config.conversion_callback = board_adc_ISR;
 
     adc_init(&adc_config);
 
@@ -10,9 +10,47 @@
 
 #include "node/node.types.h"
 
+#include "node.mapper.h"
+
+#define BOARD_ACK_MSG_COUNT 4U // Acknowledgements in flight, the hub may pipeline this many commands
+
+typedef enum board_event
+{
+    BOARD_TIMER_EVENT           = (1U << 0U),   // The next timer deadline is reached
+    BOARD_W5500_EVENT           = (1U << 1U),   // W5500 interrupt
+    BOARD_NETWORK_EVENT         = (1U << 2U),   // Time to reconnect and to retry failed messages
+    BOARD_MSG_EVENT             = (1U << 3U),   // Outbound messages are queued
+    BOARD_STATE_EVENT           = (1U << 4U),   // Mode, light command or darkness is changed
+    BOARD_LIGHT_SENSOR_EVENT    = (1U << 5U),   // Time to measure the light
+    BOARD_EXTRA_EVENT           = (1U << 6U)    // Board specific interrupts and timers
+
+} board_event_t;
+
+typedef enum board_event_source
+{
+    BOARD_DOOR_PIR_SOURCE = 0,
+    BOARD_VERANDA_PIR_SOURCE
+
+} board_event_source_t;
+
+typedef enum board_activity
+{
+    BOARD_LOOP_ACTIVITY = 0,    // Main loop and timers
+    BOARD_TCP_ACTIVITY,         // TCP client and the W5500
+    BOARD_MAPPER_ACTIVITY,      // Message serialization and parsing
+    BOARD_EXTRA_ACTIVITY,       // Board specific logic
+    BOARD_I2C_ACTIVITY,
+    BOARD_ADC_ACTIVITY,         // Light sensor
+    BOARD_LOG_ACTIVITY,         // Debug output, left out of the energy estimate
+    BOARD_ACTIVITY_COUNT
+
+} board_activity_t;
+
 typedef struct board_basic_state
 {
     size_t global_cycle_count;
+    uint32_t uptime_cycle_count;    // Does not wrap around like 'global_cycle_count'
+    uint32_t time_ms;               // Clock time of the main loop pass, as the event records
 
     bool is_dark;
     node_mode_id_t current_mode;
@@ -27,7 +65,11 @@ typedef enum board_msg_id
 {
     LIGHT_MSG = 0,
     TEMPERATURE_MSG,
-    BOARD_MSG_SIZE
+    MOTION_MSG,
+    ENERGY_MSG,
+    HANG_MSG,
+    ACK_MSG,                                        // The first of BOARD_ACK_MSG_COUNT slots
+    BOARD_MSG_SIZE = ACK_MSG + BOARD_ACK_MSG_COUNT
 
 } board_msg_id_t;
 
@@ -38,6 +80,10 @@ typedef struct board_extra_state
     size_t send_msg_retry_count[BOARD_MSG_SIZE];
     bool is_msg_to_send;
 
+    node_msg_t history_msg;         // Header and command of the sample history
+    node_mapper_history_t history;
+    bool is_history_to_send;
+
 } board_extra_state_t;
 
 #endif // BOARD_TYPES_H
\ No newline at end of file
@@ -7,10 +7,10 @@
 #include "board.types.h"
 
 #include <assert.h>
+#include <stdlib.h>
 
 #include <avr/io.h>
 #include <avr/power.h>
-#include <util/atomic.h>
 #include <util/delay.h>
 
 #include "mcu/i2c.h"
@@ -19,17 +19,35 @@
 
 #include "devices/bmp280_sensor.h"
 
+#include "node.mapper.h"
+#include "timer_wheel.h"
+#include "scheduler.h"
+#include "event_queue.h"
+#include "energy_meter.h"
+#include "coroutine.h"
+
 #include "std_error/std_error.h"
 #include "logger.h"
 
 
-#define TEMPERATURE_SENSOR_CYCLE_COUNT  8U  //  * 7,5 sec = ~ min
+#define TEMPERATURE_SENSOR_PERIOD_MS    60000UL
+
+#define TEMPERATURE_REPORT_DEADBAND     20L     // * 0.01 C
+#define PRESSURE_REPORT_DEADBAND        5L      // * 0.1 hPa
+#define TEMPERATURE_HEARTBEAT_COUNT     15U     // * TEMPERATURE_SENSOR_PERIOD_MS = ~ 15 min
+
+#define TEMPERATURE_HISTORY_CYCLE_COUNT 120UL   // * 7,5 sec = ~ 15 min (or as soon as the history is full)
 
-#define INTRUSION_WHITE_AND_RED_CYCLE_COUNT 1U  //  * 7,5 sec = ~ min
-#define INTRUSION_WHITE_CYCLE_COUNT         2U  // * 7,5 sec = ~ min
+#define MOTION_REPORT_PERIOD_MS         60000UL // The PIR counts are sent if they have changed
 
-#define SILENCE_WHITE_CYCLE_COUNT       1U  // * 7,5 sec = ~ min
-#define SILENCE_GREEN_BLUE_CYCLE_COUNT  3U  // * 7,5 sec = ~ min
+#define ALARM_PHASE_TIME_MS                 7500UL  // Blinking
+
+#define INTRUSION_WHITE_AND_RED_TIME_MS     15000UL
+#define INTRUSION_WHITE_TIME_MS             22500UL
+
+#define SILENCE_WHITE_TIME_MS               15000UL
+#define SILENCE_GREEN_BLUE_PHASE_TIME_MS    7500UL
+#define SILENCE_GREEN_BLUE_PHASE_COUNT      4U
 
 #define ARRAY_SIZE(array) (sizeof(array) / sizeof((array)[0]))
 #define UNUSED(x) (void)(x)
@@ -47,17 +65,37 @@ typedef enum light_strip_color
 } light_strip_color_t;
 
 
-static volatile bool is_int_1_interrupt;
-static volatile bool is_pcint_16_interrupt;
-
 static bool is_door_pir_interrupt;
 static bool is_veranda_pir_interrupt;
+static uint32_t door_pir_interrupt_time_ms;     // The first one of the pass
+static uint32_t veranda_pir_interrupt_time_ms;
+static uint16_t door_pir_interrupt_count;       // Since the start, they wrap around
+static uint16_t veranda_pir_interrupt_count;
+static bool is_pir_interrupt_count_changed;
+static uint16_t lost_pir_interrupt_count;
+
+static timer_wheel_timer_t motion_report_timer;
+static bool is_motion_report_timeout;
 
 static light_strip_color_t current_light_color;
 static bool is_long_range_pir_enabled;
 
+static timer_wheel_timer_t light_strip_timer;
+static bool is_light_strip_timeout;
+static size_t light_strip_phase_count;
+
+static timer_wheel_timer_t temperature_sensor_timer;
+static bool is_temperature_sensor_timeout;
+static timer_wheel_timer_t temperature_measurement_timer;
+static coroutine_t temperature_sensor_coroutine;
+static uint8_t i2c_prev_activity;
+
 
+#ifdef NODE_POWER_DOWN
+static void board_b02_pcint_19_ISR (pcint_d_state_t state);
+#else
 static void board_b02_int_1_ISR ();
+#endif // NODE_POWER_DOWN
 static void board_b02_pcint_16_ISR (pcint_d_state_t state);
 
 static void board_b02_init_i2c ();
@@ -65,28 +103,54 @@ static void board_b02_deinit_i2c ();
 
 static void board_b02_temperature_sensor_delay_ms (uint32_t delay_ms);
 
+static void board_b02_light_strip_timer_callback ();
+static void board_b02_motion_report_timer_callback ();
+static void board_b02_temperature_sensor_timer_callback ();
+static void board_b02_temperature_measurement_timer_callback ();
+
 static void board_b02_init_temperature_sensor ();
 static void board_b02_init_door_pir ();
 static void board_b02_init_veranda_pir ();
 
+static void board_b02_process_pir_interrupts ();
+static void board_b02_process_motion_report (board_extra_state_t * const extra_state);
 static void board_b02_process_light_strip (board_basic_state_t const * const basic_state, board_extra_state_t * const extra_state);
-static void board_b02_process_temperature_sensor (board_basic_state_t const * const basic_state, board_extra_state_t * const extra_state);
+static coroutine_state_t board_b02_process_temperature_sensor (board_basic_state_t const * const basic_state, board_extra_state_t * const extra_state);
 
 static void board_b02_set_light_strip_color (light_strip_color_t color);
+static uint32_t board_b02_get_phase_time_ms (uint32_t phase_time_ms, uint32_t start_time_ms, uint32_t time_ms);
 static void board_b02_power_on_long_range_pir ();
 static void board_b02_power_off_long_range_pir ();
 
 void board_b02_init ()
 {
-    is_int_1_interrupt      = false;
-    is_pcint_16_interrupt   = false;
-
-    is_door_pir_interrupt       = false;
-    is_veranda_pir_interrupt    = false;
+    is_door_pir_interrupt           = false;
+    is_veranda_pir_interrupt        = false;
+    door_pir_interrupt_time_ms      = 0UL;
+    veranda_pir_interrupt_time_ms   = 0UL;
+    door_pir_interrupt_count        = 0U;
+    veranda_pir_interrupt_count     = 0U;
+    is_pir_interrupt_count_changed  = false;
+    lost_pir_interrupt_count        = 0U;
+
+    timer_wheel_init_timer(&motion_report_timer, board_b02_motion_report_timer_callback);
+    timer_wheel_start(&motion_report_timer, MOTION_REPORT_PERIOD_MS, MOTION_REPORT_PERIOD_MS);
+    is_motion_report_timeout = false;
 
     current_light_color         = NO_LIGHT;
     is_long_range_pir_enabled   = false;
 
+    timer_wheel_init_timer(&light_strip_timer, board_b02_light_strip_timer_callback);
+    is_light_strip_timeout  = false;
+    light_strip_phase_count = 0U;
+
+    timer_wheel_init_timer(&temperature_sensor_timer, board_b02_temperature_sensor_timer_callback);
+    timer_wheel_start(&temperature_sensor_timer, TEMPERATURE_SENSOR_PERIOD_MS, TEMPERATURE_SENSOR_PERIOD_MS);
+    is_temperature_sensor_timeout = false;
+
+    timer_wheel_init_timer(&temperature_measurement_timer, board_b02_temperature_measurement_timer_callback);
+    COROUTINE_INIT(&temperature_sensor_coroutine);
+
     pcint_d_init();
 
     board_b02_init_temperature_sensor();
@@ -122,6 +186,15 @@ void board_b02_init_temperature_sensor ()
 
 void board_b02_init_door_pir ()
 {
+#ifdef NODE_POWER_DOWN
+    // Init PCINT_19 (DOOR or LONG RANGE pir interrupt), the INT_1 edges do not wake up from power-down
+    pcint_d_pin_config_t config;
+    config.pin                  = PCINT_D_19;
+    config.is_pullup_enabled    = false;
+    config.pcint_d_callback     = board_b02_pcint_19_ISR;
+
+    pcint_d_add(&config);
+#else
     // Init INT_1 (DOOR or LONG RANGE pir interrupt)
     int_1_config_t config;
     config.edge                 = EDGE_1_RISING;
@@ -129,6 +202,7 @@ void board_b02_init_door_pir ()
     config.int_1_callback       = board_b02_int_1_ISR;
 
     int_1_start(&config);
+#endif // NODE_POWER_DOWN
 
     return;
 }
@@ -152,24 +226,8 @@ void board_b02_process (board_basic_state_t const * const basic_state, board_ext
     assert(basic_state != NULL);
     assert(extra_state != NULL);
 
-    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
-    {
-        is_door_pir_interrupt       = is_int_1_interrupt;
-        is_veranda_pir_interrupt    = is_pcint_16_interrupt;
-
-        is_int_1_interrupt      = false;
-        is_pcint_16_interrupt   = false;
-    }
-
-    if (is_door_pir_interrupt == true)
-    {
-        LOG("DOOR int\r\n");
-    }
-
-    if (is_veranda_pir_interrupt == true)
-    {
-        LOG("VER int\r\n");
-    }
+    board_b02_process_pir_interrupts();
+    board_b02_process_motion_report(extra_state);
 
     board_b02_process_light_strip(basic_state, extra_state);
     board_b02_process_temperature_sensor(basic_state, extra_state);
@@ -189,22 +247,96 @@ void board_b02_process (board_basic_state_t const * const basic_state, board_ext
 }
 
 
-void board_b02_process_light_strip (board_basic_state_t const * const basic_state, board_extra_state_t * const extra_state)
+void board_b02_process_pir_interrupts ()
 {
-    assert(basic_state != NULL);
-    assert(extra_state != NULL);
+    is_door_pir_interrupt       = false;
+    is_veranda_pir_interrupt    = false;
 
-    static size_t prev_cycle_count = 0U;
+    // Every interrupt is drained and counted, the light strip starts from the time of the first one
+    event_queue_record_t record;
 
-    if (basic_state->global_cycle_count < prev_cycle_count)
+    while (event_queue_pop(&record) == true)
     {
-        prev_cycle_count = basic_state->global_cycle_count;
+        if (record.source == BOARD_DOOR_PIR_SOURCE)
+        {
+            if (is_door_pir_interrupt == false)
+            {
+                is_door_pir_interrupt = true;
+                door_pir_interrupt_time_ms = record.time_ms;
+            }
+            ++door_pir_interrupt_count;
+        }
+        else if (record.source == BOARD_VERANDA_PIR_SOURCE)
+        {
+            if (is_veranda_pir_interrupt == false)
+            {
+                is_veranda_pir_interrupt = true;
+                veranda_pir_interrupt_time_ms = record.time_ms;
+            }
+            ++veranda_pir_interrupt_count;
+        }
+        is_pir_interrupt_count_changed = true;
     }
 
+    // The hub sees the lost ones as a gap between the counts and the lights
+    const uint16_t lost_count = event_queue_get_lost_count();
+
+    if (lost_count != lost_pir_interrupt_count)
+    {
+        lost_pir_interrupt_count = lost_count;
+
+        LOG("Lost int: %u\r\n", lost_count);
+    }
+    return;
+}
+
+void board_b02_process_motion_report (board_extra_state_t * const extra_state)
+{
+    assert(extra_state != NULL);
+
+    if (is_motion_report_timeout == true)
+    {
+        is_motion_report_timeout = false;
+
+        // The counts are totals, so a report, which is replaced before it is sent, loses nothing
+        if (is_pir_interrupt_count_changed == true)
+        {
+            is_pir_interrupt_count_changed = false;
+
+            extra_state->send_msg_array[MOTION_MSG].header.source           = NODE_B02;
+            extra_state->send_msg_array[MOTION_MSG].header.dest_array[0]    = NODE_B01;
+            extra_state->send_msg_array[MOTION_MSG].header.dest_array_size  = 1U;
+
+            extra_state->send_msg_array[MOTION_MSG].cmd_id  = (node_command_id_t)(NODE_MAPPER_MOTION_CMD_ID);
+            extra_state->send_msg_array[MOTION_MSG].value_0 = NODE_MAPPER_PACK_MOTION(door_pir_interrupt_count, veranda_pir_interrupt_count);
+
+            extra_state->send_msg_retry_count[MOTION_MSG] = 0U;
+
+            extra_state->is_msg_to_send = true;
+
+            LOG("PIR int: door %u, veranda %u\r\n", door_pir_interrupt_count, veranda_pir_interrupt_count);
+        }
+    }
+    return;
+}
+
+void board_b02_process_light_strip (board_basic_state_t const * const basic_state, board_extra_state_t * const extra_state)
+{
+    assert(basic_state != NULL);
+    assert(extra_state != NULL);
+
+    const bool is_light_strip_phase_end = is_light_strip_timeout;
+    is_light_strip_timeout = false;
+
     // Alarm mode
     if (basic_state->current_mode == ALARM)
     {
-        if (prev_cycle_count != basic_state->global_cycle_count)
+        if (timer_wheel_is_running(&light_strip_timer) == false)
+        {
+            timer_wheel_start(&light_strip_timer, ALARM_PHASE_TIME_MS, ALARM_PHASE_TIME_MS);
+        }
+
+        if (is_light_strip_phase_end == true)
         {
             if (basic_state->is_dark == true)
             {
@@ -232,7 +364,6 @@ void board_b02_process_light_strip (board_basic_state_t const * const basic_stat
                     current_light_color = NO_LIGHT;
                 }
             }
-            prev_cycle_count = basic_state->global_cycle_count;
         }
     }
 
@@ -249,7 +380,18 @@ void board_b02_process_light_strip (board_basic_state_t const * const basic_stat
                 board_b02_set_light_strip_color(WHITE_AND_RED_LIGHT);
                 current_light_color = WHITE_AND_RED_LIGHT;
 
-                prev_cycle_count = basic_state->global_cycle_count;
+                uint32_t start_time_ms = basic_state->time_ms;
+
+                if ((is_door_pir_interrupt == true) && ((int32_t)(door_pir_interrupt_time_ms - start_time_ms) < 0L))
+                {
+                    start_time_ms = door_pir_interrupt_time_ms;
+                }
+
+                if ((is_veranda_pir_interrupt == true) && ((int32_t)(veranda_pir_interrupt_time_ms - start_time_ms) < 0L))
+                {
+                    start_time_ms = veranda_pir_interrupt_time_ms;
+                }
+                timer_wheel_start(&light_strip_timer, board_b02_get_phase_time_ms(INTRUSION_WHITE_AND_RED_TIME_MS, start_time_ms, basic_state->time_ms), 0UL);
 
                 if (is_pir_interrupt == true)
                 {
@@ -273,26 +415,20 @@ void board_b02_process_light_strip (board_basic_state_t const * const basic_stat
         }
         else if (current_light_color != WHITE_LIGHT)
         {
-            const bool is_time_to_stop = (basic_state->global_cycle_count - prev_cycle_count) > INTRUSION_WHITE_AND_RED_CYCLE_COUNT;
-
-            if (is_time_to_stop == true)
+            if (is_light_strip_phase_end == true)
             {
                 board_b02_set_light_strip_color(WHITE_LIGHT);
                 current_light_color = WHITE_LIGHT;
 
-                prev_cycle_count = basic_state->global_cycle_count;
+                timer_wheel_start(&light_strip_timer, INTRUSION_WHITE_TIME_MS, 0UL);
             }
         }
         else
         {
-            const bool is_time_to_stop = (basic_state->global_cycle_count - prev_cycle_count) > INTRUSION_WHITE_CYCLE_COUNT;
-
-            if (is_time_to_stop == true)
+            if (is_light_strip_phase_end == true)
             {
                 board_b02_set_light_strip_color(NO_LIGHT);
                 current_light_color = NO_LIGHT;
-
-                prev_cycle_count = basic_state->global_cycle_count;
             }
         }
     }
@@ -309,7 +445,9 @@ void board_b02_process_light_strip (board_basic_state_t const * const basic_stat
                 board_b02_set_light_strip_color(WHITE_LIGHT);
                 current_light_color = WHITE_LIGHT;
 
-                prev_cycle_count = basic_state->global_cycle_count;
+                const uint32_t start_time_ms = (is_door_pir_interrupt == true) ? door_pir_interrupt_time_ms : basic_state->time_ms;
+
+                timer_wheel_start(&light_strip_timer, board_b02_get_phase_time_ms(SILENCE_WHITE_TIME_MS, start_time_ms, basic_state->time_ms), 0UL);
 
                 if (is_door_pir_interrupt == true)
                 {
@@ -328,16 +466,16 @@ void board_b02_process_light_strip (board_basic_state_t const * const basic_stat
                     extra_state->is_msg_to_send = true;
                 }
             }
-            else
+            else if (is_light_strip_phase_end == true)
             {
-                const bool is_time_to_stop = (basic_state->global_cycle_count - prev_cycle_count) > SILENCE_GREEN_BLUE_CYCLE_COUNT;
+                ++light_strip_phase_count;
 
-                if (is_time_to_stop == true)
+                if (light_strip_phase_count >= SILENCE_GREEN_BLUE_PHASE_COUNT)
                 {
+                    timer_wheel_stop(&light_strip_timer);
+
                     board_b02_set_light_strip_color(NO_LIGHT);
                     current_light_color = NO_LIGHT;
-
-                    prev_cycle_count = basic_state->global_cycle_count;
                 }
                 else
                 {
@@ -356,20 +494,21 @@ void board_b02_process_light_strip (board_basic_state_t const * const basic_stat
         }
         else
         {
-            const bool is_time_to_stop = (basic_state->global_cycle_count - prev_cycle_count) > SILENCE_WHITE_CYCLE_COUNT;
-
-            if (is_time_to_stop == true)
+            if (is_light_strip_phase_end == true)
             {
                 board_b02_set_light_strip_color(GREEN_LIGHT);
                 current_light_color = GREEN_LIGHT;
 
-                prev_cycle_count = basic_state->global_cycle_count;
+                light_strip_phase_count = 0U;
+                timer_wheel_start(&light_strip_timer, SILENCE_GREEN_BLUE_PHASE_TIME_MS, SILENCE_GREEN_BLUE_PHASE_TIME_MS);
             }
         }
     }
 
     if ((basic_state->current_mode != basic_state->new_mode) || (basic_state->is_disable_light_command == true))
     {
+        timer_wheel_stop(&light_strip_timer);
+
         board_b02_set_light_strip_color(NO_LIGHT);
         current_light_color = NO_LIGHT;
     }
@@ -377,59 +516,121 @@ void board_b02_process_light_strip (board_basic_state_t const * const basic_stat
     return;
 }
 
-void board_b02_process_temperature_sensor (board_basic_state_t const * const basic_state, board_extra_state_t * const extra_state)
+coroutine_state_t board_b02_process_temperature_sensor (board_basic_state_t const * const basic_state, board_extra_state_t * const extra_state)
 {
     assert(basic_state != NULL);
     assert(extra_state != NULL);
 
-    static size_t prev_cycle_count = 0U;
-
-    if (basic_state->global_cycle_count < prev_cycle_count)
-    {
-        prev_cycle_count = basic_state->global_cycle_count;
-    }
+    std_error_t error;
+    std_error_init(&error);
 
-    const bool is_measuring_cycle = (basic_state->global_cycle_count - prev_cycle_count) > TEMPERATURE_SENSOR_CYCLE_COUNT;
+    COROUTINE_BEGIN(&temperature_sensor_coroutine);
 
-    if (is_measuring_cycle == true)
+    if (is_temperature_sensor_timeout == true)
     {
-        std_error_t error;
-        std_error_init(&error);
+        is_temperature_sensor_timeout = false;
 
+        // The sensor measures on its own, the bus is released meanwhile
         board_b02_init_i2c();
 
-        bmp280_sensor_data_t data;
+        const int exit_code = bmp280_sensor_start_measurement(&error);
 
-        if (bmp280_sensor_read_data(&data, &error) != STD_SUCCESS)
+        board_b02_deinit_i2c();
+
+        if (exit_code != STD_SUCCESS)
         {
             LOG("%s\r\n", error.text);
         }
         else
         {
-            LOG("Press: %d hPa\r\n", (int)data.pressure_hPa);
-            LOG("Temp: %d C\r\n", (int)data.temperature_C);
+            timer_wheel_start(&temperature_measurement_timer, bmp280_sensor_get_measurement_time_ms(), 0UL);
+
+            COROUTINE_WAIT_UNTIL(&temperature_sensor_coroutine, timer_wheel_is_running(&temperature_measurement_timer) == false);
+
+            board_b02_init_i2c();
 
-            size_t i = 0U;
+            bmp280_sensor_data_t data;
 
-            extra_state->send_msg_array[TEMPERATURE_MSG].header.source          = NODE_B02;
-            extra_state->send_msg_array[TEMPERATURE_MSG].header.dest_array[i]   = NODE_B01;
-            ++i;
-            extra_state->send_msg_array[TEMPERATURE_MSG].header.dest_array_size = i;
+            if (bmp280_sensor_read_measurement(&data, &error) != STD_SUCCESS)
+            {
+                LOG("%s\r\n", error.text);
+            }
+            else
+            {
+                LOG("Press: %lu Pa\r\n", (unsigned long)data.pressure_Pa);
+                LOG("Temp: %ld cC\r\n", (long)data.temperature_C_x100);
 
-            extra_state->send_msg_array[TEMPERATURE_MSG].cmd_id     = UPDATE_TEMPERATURE;
-            extra_state->send_msg_array[TEMPERATURE_MSG].value_0    = (int32_t)data.pressure_hPa;
-            extra_state->send_msg_array[TEMPERATURE_MSG].value_1    = data.temperature_C;
+                const int32_t pressure_hPa_x10 = (int32_t)(data.pressure_Pa / 10UL);
 
-            extra_state->send_msg_retry_count[TEMPERATURE_MSG] = 0U;
+                // Every reading goes into the history, which is uploaded as one message (values in the schema order)
+                node_mapper_sample_t sample;
+                sample.time             = basic_state->uptime_cycle_count;
+                sample.value_array[0]   = pressure_hPa_x10;
+                sample.value_array[1]   = data.temperature_C_x100;
 
-            extra_state->is_msg_to_send = true;
-        }
+                node_mapper_push_sample(&extra_state->history, &sample);
 
-        board_b02_deinit_i2c();
+                const uint32_t history_age = basic_state->uptime_cycle_count - extra_state->history.sample_array[extra_state->history.first_index].time;
+                const bool is_history_full = (extra_state->history.size == ARRAY_SIZE(extra_state->history.sample_array));
+
+                if ((is_history_full == true) || (history_age >= TEMPERATURE_HISTORY_CYCLE_COUNT))
+                {
+                    extra_state->history_msg.header.source          = NODE_B02;
+                    extra_state->history_msg.header.dest_array[0]   = NODE_B01;
+                    extra_state->history_msg.header.dest_array_size = 1U;
+
+                    extra_state->history_msg.cmd_id = (node_command_id_t)(NODE_MAPPER_HISTORY_CMD_ID);
+
+                    extra_state->is_history_to_send = true;
+                    extra_state->is_msg_to_send     = true;
+                }
+
+                static bool is_reported = false;
+                static int32_t reported_pressure_hPa_x10 = 0L;
+                static int32_t reported_temperature_C_x100 = 0L;
+                static size_t skipped_report_count = 0U;
+
+                const int32_t pressure_delta = labs(pressure_hPa_x10 - reported_pressure_hPa_x10);
+                const int32_t temperature_delta = labs(data.temperature_C_x100 - reported_temperature_C_x100);
+
+                const bool is_time_to_report =  (is_reported == false) ||
+                                                (pressure_delta >= PRESSURE_REPORT_DEADBAND) ||
+                                                (temperature_delta >= TEMPERATURE_REPORT_DEADBAND) ||
+                                                (skipped_report_count >= TEMPERATURE_HEARTBEAT_COUNT);
+
+                if (is_time_to_report == true)
+                {
+                    is_reported                 = true;
+                    reported_pressure_hPa_x10   = pressure_hPa_x10;
+                    reported_temperature_C_x100 = data.temperature_C_x100;
+                    skipped_report_count        = 0U;
+
+                    size_t i = 0U;
+
+                    extra_state->send_msg_array[TEMPERATURE_MSG].header.source          = NODE_B02;
+                    extra_state->send_msg_array[TEMPERATURE_MSG].header.dest_array[i]   = NODE_B01;
+                    ++i;
+                    extra_state->send_msg_array[TEMPERATURE_MSG].header.dest_array_size = i;
+
+                    extra_state->send_msg_array[TEMPERATURE_MSG].cmd_id     = UPDATE_TEMPERATURE;
+                    extra_state->send_msg_array[TEMPERATURE_MSG].value_0    = NODE_MAPPER_PACK_TEMPERATURE(pressure_hPa_x10, data.temperature_C_x100);
+
+                    extra_state->send_msg_retry_count[TEMPERATURE_MSG] = 0U;
+
+                    extra_state->is_msg_to_send = true;
+                }
+                else
+                {
+                    ++skipped_report_count;
+                    LOG("Temp unchanged\r\n");
+                }
+            }
 
-        prev_cycle_count = basic_state->global_cycle_count;
+            board_b02_deinit_i2c();
+        }
     }
-    return;
+
+    COROUTINE_END(&temperature_sensor_coroutine);
 }
 
 void board_b02_set_light_strip_color (light_strip_color_t color)
@@ -461,6 +662,18 @@ void board_b02_set_light_strip_color (light_strip_color_t color)
     return;
 }
 
+uint32_t board_b02_get_phase_time_ms (uint32_t phase_time_ms, uint32_t start_time_ms, uint32_t time_ms)
+{
+    // The phase is counted from the interrupt, not from the pass which has got to it (an interrupt after the pass time is not late)
+    const int32_t late_ms = (int32_t)(time_ms - start_time_ms);
+
+    if (late_ms <= 0L)
+    {
+        return phase_time_ms;
+    }
+    return ((uint32_t)(late_ms) < phase_time_ms) ? (phase_time_ms - (uint32_t)(late_ms)) : 0UL;
+}
+
 void board_b02_power_on_long_range_pir ()
 {
     LOG("power on LONG RANGE pir\r\n");
@@ -478,36 +691,82 @@ void board_b02_power_off_long_range_pir ()
 }
 
 
-void board_b02_is_interrupt (bool * const is_interrupt)
+void board_b02_temperature_sensor_delay_ms (uint32_t delay_ms)
+{
+    // Only the sensor initialization waits here, the measurements do not
+    for (uint32_t i = 0UL; i < delay_ms; ++i)
+    {
+        _delay_ms(1);
+    }
+    return;
+}
+
+
+void board_b02_light_strip_timer_callback ()
 {
-    *is_interrupt = (is_int_1_interrupt != false) || (is_pcint_16_interrupt != false);
+    is_light_strip_timeout = true;
+
+    scheduler_post_event(BOARD_EXTRA_EVENT);
 
     return;
 }
 
+void board_b02_motion_report_timer_callback ()
+{
+    is_motion_report_timeout = true;
+
+    scheduler_post_event(BOARD_EXTRA_EVENT);
 
-void board_b02_temperature_sensor_delay_ms (uint32_t delay_ms)
+    return;
+}
+
+void board_b02_temperature_sensor_timer_callback ()
 {
-    UNUSED(delay_ms);
+    is_temperature_sensor_timeout = true;
 
-    _delay_ms(160);
+    scheduler_post_event(BOARD_EXTRA_EVENT);
 
     return;
 }
 
+void board_b02_temperature_measurement_timer_callback ()
+{
+    scheduler_post_event(BOARD_EXTRA_EVENT);
 
+    return;
+}
+
+
+#ifdef NODE_POWER_DOWN
+void board_b02_pcint_19_ISR (pcint_d_state_t state)
+{
+    // PCINT19 shares the pin with INT1
+    if (state == STATE_D_HIGH)
+    {
+        event_queue_push(BOARD_DOOR_PIR_SOURCE);
+
+        scheduler_post_event(BOARD_EXTRA_EVENT);
+    }
+    return;
+}
+#else
 void board_b02_int_1_ISR ()
 {
-    is_int_1_interrupt = true;
+    event_queue_push(BOARD_DOOR_PIR_SOURCE);
+
+    scheduler_post_event(BOARD_EXTRA_EVENT);
 
     return;
 }
+#endif // NODE_POWER_DOWN
 
 void board_b02_pcint_16_ISR (pcint_d_state_t state)
 {
     if (state == STATE_D_HIGH)
     {
-        is_pcint_16_interrupt = true;
+        event_queue_push(BOARD_VERANDA_PIR_SOURCE);
+
+        scheduler_post_event(BOARD_EXTRA_EVENT);
     }
     return;
 }
@@ -517,6 +776,9 @@ void board_b02_init_i2c ()
 {
     power_twi_enable();
 
+    // The time the bus is held is counted as I2C
+    i2c_prev_activity = energy_meter_switch(BOARD_I2C_ACTIVITY);
+
     i2c_config_t config;
     config.frequency            = SCL_400KHz;
     config.is_pullup_enabled    = false;
@@ -532,5 +794,7 @@ void board_b02_deinit_i2c ()
 
     power_twi_disable();
 
+    energy_meter_switch(i2c_prev_activity);
+
     return;
 }
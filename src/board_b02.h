@@ -13,6 +13,5 @@ typedef struct board_extra_state board_extra_state_t;
 
 void board_b02_init ();
 void board_b02_process (board_basic_state_t const * const basic_state, board_extra_state_t * const extra_state);
-void board_b02_is_interrupt (bool * const is_interrupt);
 
 #endif // BOARD_B02_H
\ No newline at end of file
@@ -0,0 +1,52 @@
+/************************************************************
+ *   Author : German Mundinger
+ *   Date   : 2023
+ ************************************************************/
+
+#ifndef COROUTINE_H
+#define COROUTINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Stackless coroutines: a coroutine function returns at a wait and goes on from there on the next call.
+// Local variables do not survive a wait (keep them static), a wait can not be put inside a 'switch'
+// and there can be only one wait per source line
+
+typedef struct coroutine
+{
+    uint16_t line; // Where to go on, 0 - from the beginning
+
+} coroutine_t;
+
+typedef enum coroutine_state
+{
+    COROUTINE_WAITING = 0,
+    COROUTINE_DONE
+
+} coroutine_state_t;
+
+#define COROUTINE_INIT(coroutine)       ((coroutine)->line = 0U)
+#define COROUTINE_IS_RUNNING(coroutine) ((coroutine)->line != 0U)
+
+#define COROUTINE_BEGIN(coroutine)  \
+    switch ((coroutine)->line)      \
+    {                               \
+        case 0U:
+
+// The condition is checked on every call, the caller calls again as soon as it may have changed
+#define COROUTINE_WAIT_UNTIL(coroutine, condition)  \
+        (coroutine)->line = (uint16_t)(__LINE__);   \
+        __attribute__((fallthrough));               \
+        case __LINE__:                              \
+        if (!(condition))                           \
+        {                                           \
+            return COROUTINE_WAITING;               \
+        }
+
+#define COROUTINE_END(coroutine)    \
+    }                               \
+    (coroutine)->line = 0U;         \
+    return COROUTINE_DONE;
+
+#endif // COROUTINE_H
\ No newline at end of file
@@ -90,28 +90,50 @@ int bmp280_sensor_init (bmp280_sensor_config_t const * const init_config, std_er
 }
 
 int bmp280_sensor_read_data (bmp280_sensor_data_t * const data, std_error_t * const error)
+{
+    if (bmp280_sensor_start_measurement(error) != STD_SUCCESS)
+    {
+        return STD_FAILURE;
+    }
+
+    config.delay_callback(delay_ms);
+
+    return bmp280_sensor_read_measurement(data, error);
+}
+
+int bmp280_sensor_start_measurement (std_error_t * const error)
 {
     device.intf_ptr = (void*)error;
 
-    int8_t exit_code = bmp2_set_power_mode(BMP2_POWERMODE_FORCED, &device_config, &device);
+    const int8_t exit_code = bmp2_set_power_mode(BMP2_POWERMODE_FORCED, &device_config, &device);
 
     if (exit_code != BMP2_OK)
     {
         return STD_FAILURE;
     }
+    return STD_SUCCESS;
+}
 
-    config.delay_callback(delay_ms);
+uint32_t bmp280_sensor_get_measurement_time_ms ()
+{
+    return delay_ms;
+}
+
+int bmp280_sensor_read_measurement (bmp280_sensor_data_t * const data, std_error_t * const error)
+{
+    device.intf_ptr = (void*)error;
 
     struct bmp2_data sensor_data;
-    exit_code = bmp2_get_sensor_data(&sensor_data, &device);
+    const int8_t exit_code = bmp2_get_sensor_data(&sensor_data, &device);
 
     if (exit_code != BMP2_OK)
     {
         return STD_FAILURE;
     }
 
-    data->temperature_C = (float)sensor_data.temperature;
-    data->pressure_hPa  = (float)(0.01 * sensor_data.pressure);
+    // Integer compensation: no soft-float on the AVR
+    data->temperature_C_x100    = sensor_data.temperature;
+    data->pressure_Pa           = sensor_data.pressure;
 
     return STD_SUCCESS;
 }
@@ -23,8 +23,8 @@ typedef struct bmp280_sensor_config
 
 typedef struct bmp280_sensor_data
 {
-    float pressure_hPa;
-    float temperature_C;
+    uint32_t pressure_Pa;
+    int32_t temperature_C_x100; // 0.01 C
 
 } bmp280_sensor_data_t;
 
@@ -32,4 +32,9 @@ int bmp280_sensor_init (bmp280_sensor_config_t const * const init_config, std_er
 
 int bmp280_sensor_read_data (bmp280_sensor_data_t * const data, std_error_t * const error);
 
+// The same in steps, so the caller does not wait in 'delay_callback' (the bus may be released meanwhile)
+int bmp280_sensor_start_measurement (std_error_t * const error);
+uint32_t bmp280_sensor_get_measurement_time_ms ();
+int bmp280_sensor_read_measurement (bmp280_sensor_data_t * const data, std_error_t * const error);
+
 #endif // BMP280_SENSOR_H
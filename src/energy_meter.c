@@ -0,0 +1,178 @@
+/************************************************************
+ *   Author : German Mundinger
+ *   Date   : 2023
+ ************************************************************/
+
+#include "energy_meter.h"
+
+#include <stdbool.h>
+#include <assert.h>
+
+
+#define ARRAY_SIZE(array) (sizeof(array) / sizeof((array)[0]))
+
+
+static energy_meter_config_t config;
+static energy_meter_report_t accounts;
+
+static uint8_t current_activity;
+static uint8_t peripheral_mask;     // At the start of the current interval
+static uint32_t interval_time_us;   // Start of the current interval
+static bool is_awake;
+
+
+static void energy_meter_charge (uint32_t time_us);
+static uint32_t energy_meter_get_current_uA (uint16_t current_uA, uint32_t time_us, uint32_t period_ms);
+
+void energy_meter_init (energy_meter_config_t const * const init_config)
+{
+    assert(init_config != NULL);
+    assert(init_config->time_callback != NULL);
+    assert(init_config->peripheral_callback != NULL);
+    assert(init_config->activity_array_size != 0U);
+    assert(init_config->activity_array_size <= ENERGY_METER_ACTIVITY_MAX_COUNT);
+
+    config = *init_config;
+
+    accounts.period_ms      = 0UL;
+    accounts.awake_time_us  = 0UL;
+
+    for (size_t i = 0U; i < ARRAY_SIZE(accounts.activity_time_us_array); ++i)
+    {
+        accounts.activity_time_us_array[i] = 0UL;
+    }
+
+    for (size_t i = 0U; i < ARRAY_SIZE(accounts.peripheral_time_us_array); ++i)
+    {
+        accounts.peripheral_time_us_array[i] = 0UL;
+    }
+    accounts.average_current_uA = 0UL;
+
+    current_activity    = 0U;
+    peripheral_mask     = 0U;
+    interval_time_us    = 0UL;
+    is_awake            = false;
+
+    return;
+}
+
+uint8_t energy_meter_switch (uint8_t activity)
+{
+    assert(activity < config.activity_array_size);
+
+    const uint32_t time_us = config.time_callback();
+    const uint8_t prev_activity = current_activity;
+
+    if (is_awake == true)
+    {
+        energy_meter_charge(time_us);
+    }
+
+    current_activity    = activity;
+    peripheral_mask     = config.peripheral_callback();
+    interval_time_us    = time_us;
+    is_awake            = true;
+
+    return prev_activity;
+}
+
+void energy_meter_sleep ()
+{
+    if (is_awake == true)
+    {
+        energy_meter_charge(config.time_callback());
+
+        is_awake = false;
+    }
+    return;
+}
+
+void energy_meter_report (uint32_t period_ms, energy_meter_report_t * const report)
+{
+    assert(report != NULL);
+    assert(period_ms <= ENERGY_METER_MAX_PERIOD_MS);
+
+    // The current interval is split at the report
+    if (is_awake == true)
+    {
+        const uint32_t time_us = config.time_callback();
+
+        energy_meter_charge(time_us);
+
+        peripheral_mask     = config.peripheral_callback();
+        interval_time_us    = time_us;
+    }
+
+    *report = accounts;
+    report->period_ms = period_ms;
+
+    uint32_t current_uA = config.base_current_uA;
+
+    if (period_ms != 0UL)
+    {
+        const uint32_t awake_time_ms = report->awake_time_us / 1000UL;
+
+        if (awake_time_ms < period_ms)
+        {
+            current_uA += energy_meter_get_current_uA(config.sleep_current_uA, (period_ms - awake_time_ms) * 1000UL, period_ms);
+        }
+
+        for (size_t i = 0U; i < config.activity_array_size; ++i)
+        {
+            if ((config.excluded_activity_mask & (1U << i)) != 0U)
+            {
+                continue;
+            }
+            current_uA += energy_meter_get_current_uA(config.activity_current_uA_array[i], report->activity_time_us_array[i], period_ms);
+        }
+
+        for (size_t i = 0U; i < ARRAY_SIZE(config.peripheral_current_uA_array); ++i)
+        {
+            current_uA += energy_meter_get_current_uA(config.peripheral_current_uA_array[i], report->peripheral_time_us_array[i], period_ms);
+        }
+    }
+    report->average_current_uA = current_uA;
+
+    accounts.awake_time_us = 0UL;
+
+    for (size_t i = 0U; i < ARRAY_SIZE(accounts.activity_time_us_array); ++i)
+    {
+        accounts.activity_time_us_array[i] = 0UL;
+    }
+
+    for (size_t i = 0U; i < ARRAY_SIZE(accounts.peripheral_time_us_array); ++i)
+    {
+        accounts.peripheral_time_us_array[i] = 0UL;
+    }
+    return;
+}
+
+
+void energy_meter_charge (uint32_t time_us)
+{
+    const uint32_t interval_us = time_us - interval_time_us;
+
+    accounts.activity_time_us_array[current_activity] += interval_us;
+
+    // Left out of the awake time, so the report counts it as sleep
+    if ((config.excluded_activity_mask & (1U << current_activity)) != 0U)
+    {
+        return;
+    }
+    accounts.awake_time_us += interval_us;
+
+    for (size_t i = 0U; i < ARRAY_SIZE(accounts.peripheral_time_us_array); ++i)
+    {
+        if ((peripheral_mask & (1U << i)) != 0U)
+        {
+            accounts.peripheral_time_us_array[i] += interval_us;
+        }
+    }
+    return;
+}
+
+uint32_t energy_meter_get_current_uA (uint16_t current_uA, uint32_t time_us, uint32_t period_ms)
+{
+    // The share of the period, in milliseconds to stay in 32 bits
+    return ((uint32_t)(current_uA) * (time_us / 1000UL)) / period_ms;
+}
@@ -0,0 +1,54 @@
+/************************************************************
+ *   Author : German Mundinger
+ *   Date   : 2023
+ ************************************************************/
+
+#ifndef ENERGY_METER_H
+#define ENERGY_METER_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define ENERGY_METER_ACTIVITY_MAX_COUNT 8U
+#define ENERGY_METER_PERIPHERAL_COUNT   8U      // One per bit of the peripheral mask
+#define ENERGY_METER_MAX_PERIOD_MS      65000UL // Charges are counted in 32 bits, currents are up to ~65 mA
+
+typedef uint32_t (*energy_meter_time_callback_t) ();        // Microseconds, has to run at least while the MCU is awake
+typedef uint8_t (*energy_meter_peripheral_callback_t) ();   // One bit per powered peripheral
+
+typedef struct energy_meter_config
+{
+    energy_meter_time_callback_t time_callback;
+    energy_meter_peripheral_callback_t peripheral_callback;
+
+    uint16_t activity_current_uA_array[ENERGY_METER_ACTIVITY_MAX_COUNT];     // The MCU, while it is awake
+    size_t activity_array_size;
+    uint8_t excluded_activity_mask; // Bit per activity, which only exists for debugging (e.g. logging): its time is reported, but estimated as sleep
+    uint16_t peripheral_current_uA_array[ENERGY_METER_PERIPHERAL_COUNT];     // Added while the MCU is awake
+    uint16_t sleep_current_uA;  // The rest of the time
+    uint32_t base_current_uA;   // The rest of the board, drawn all the time
+
+} energy_meter_config_t;
+
+typedef struct energy_meter_report
+{
+    uint32_t period_ms;
+    uint32_t awake_time_us;
+    uint32_t activity_time_us_array[ENERGY_METER_ACTIVITY_MAX_COUNT];
+    uint32_t peripheral_time_us_array[ENERGY_METER_PERIPHERAL_COUNT];
+    uint32_t average_current_uA; // Charge per hour in uAh
+
+} energy_meter_report_t;
+
+void energy_meter_init (energy_meter_config_t const * const init_config);
+
+// Charges the time since the previous switch, the returned activity is the one to switch back to (nested activities)
+uint8_t energy_meter_switch (uint8_t activity);
+
+// The time till the next switch is charged as sleep
+void energy_meter_sleep ();
+
+// Takes the accounts since the previous report
+void energy_meter_report (uint32_t period_ms, energy_meter_report_t * const report);
+
+#endif // ENERGY_METER_H
\ No newline at end of file
@@ -0,0 +1,93 @@
+/************************************************************
+ *   Author : German Mundinger
+ *   Date   : 2023
+ ************************************************************/
+
+#include "event_queue.h"
+
+#include <stddef.h>
+#include <assert.h>
+
+#include <util/atomic.h>
+
+
+#define INDEX_MASK (EVENT_QUEUE_SIZE - 1U)
+
+
+static event_queue_config_t config;
+
+// The indexes run freely and wrap around, each one is written by one side only (8-bit writes are atomic)
+static volatile event_queue_record_t record_array[EVENT_QUEUE_SIZE];
+static volatile uint8_t head_index;
+static volatile uint8_t tail_index;
+static volatile uint16_t lost_count;
+
+
+void event_queue_init (event_queue_config_t const * const init_config)
+{
+    assert(init_config != NULL);
+    assert(init_config->time_callback != NULL);
+    assert((EVENT_QUEUE_SIZE & INDEX_MASK) == 0U);
+    assert(EVENT_QUEUE_SIZE <= 128U);
+
+    config = *init_config;
+
+    head_index  = 0U;
+    tail_index  = 0U;
+    lost_count  = 0U;
+
+    return;
+}
+
+void event_queue_push (uint8_t source)
+{
+    const uint8_t head = head_index;
+
+    if ((uint8_t)(head - tail_index) >= EVENT_QUEUE_SIZE)
+    {
+        ++lost_count;
+
+        return;
+    }
+
+    volatile event_queue_record_t * const record = &record_array[head & INDEX_MASK];
+    record->time_ms = config.time_callback();
+    record->source  = source;
+
+    // Published after the record is written (volatile accesses keep their order)
+    head_index = (uint8_t)(head + 1U);
+
+    return;
+}
+
+bool event_queue_pop (event_queue_record_t * const record)
+{
+    assert(record != NULL);
+
+    const uint8_t tail = tail_index;
+
+    if (tail == head_index)
+    {
+        return false;
+    }
+
+    volatile event_queue_record_t const * const queued_record = &record_array[tail & INDEX_MASK];
+    record->time_ms = queued_record->time_ms;
+    record->source  = queued_record->source;
+
+    // The slot is given back after it is read
+    tail_index = (uint8_t)(tail + 1U);
+
+    return true;
+}
+
+uint16_t event_queue_get_lost_count ()
+{
+    uint16_t count;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        count = lost_count;
+    }
+    return count;
+}
@@ -0,0 +1,40 @@
+/************************************************************
+ *   Author : German Mundinger
+ *   Date   : 2023
+ ************************************************************/
+
+#ifndef EVENT_QUEUE_H
+#define EVENT_QUEUE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifndef EVENT_QUEUE_SIZE
+#define EVENT_QUEUE_SIZE 16U // Records, power of 2 up to 128
+#endif // EVENT_QUEUE_SIZE
+
+typedef uint32_t (*event_queue_time_callback_t) ();
+
+typedef struct event_queue_record
+{
+    uint32_t time_ms;
+    uint8_t source;     // Defined by the user
+
+} event_queue_record_t;
+
+typedef struct event_queue_config
+{
+    event_queue_time_callback_t time_callback; // Called from the interrupts
+
+} event_queue_config_t;
+
+void event_queue_init (event_queue_config_t const * const init_config);
+
+// Single producer: interrupts (they do not nest), a full queue drops the record and counts it
+void event_queue_push (uint8_t source);
+
+// Single consumer: the main loop, nothing is locked on either side
+bool event_queue_pop (event_queue_record_t * const record);
+uint16_t event_queue_get_lost_count ();
+
+#endif // EVENT_QUEUE_H
\ No newline at end of file
@@ -14,6 +14,6 @@
 #define LWJSON_CFG_STREAM_KEY_MAX_LEN 8
 #define LWJSON_CFG_STREAM_STACK_SIZE 4
 #define LWJSON_CFG_STREAM_STRING_MAX_LEN 2
-#define LWJSON_CFG_STREAM_PRIMITIVE_MAX_LEN 6
+#define LWJSON_CFG_STREAM_PRIMITIVE_MAX_LEN 10 // dst_mask takes up to 10 digits
 
 #endif // LWJSON_HDR_OPTS_H
@@ -8,53 +8,59 @@
 #include <assert.h>
 
 #include <avr/io.h>
+#include <avr/interrupt.h>
 
 
-void adc_init (adc_config_t const * const config)
+static adc_config_t config;
+
+
+void adc_init (adc_config_t const * const init_config)
 {
-	assert(config != NULL);
+	assert(init_config != NULL);
+
+	config = *init_config;
 
 	// Select reference voltage
-	if (config->ref_voltage == ADC_REF_VOLTAGE_INTERNAL_1V1)
+	if (config.ref_voltage == ADC_REF_VOLTAGE_INTERNAL_1V1)
 	{
 		ADMUX |= (1 << REFS1) | (1 << REFS0);
 	}
-	else if (config->ref_voltage == ADC_REF_VOLTAGE_AVCC)
+	else if (config.ref_voltage == ADC_REF_VOLTAGE_AVCC)
 	{
 		ADMUX &= ~(1 << REFS1);
 		ADMUX |= (1 << REFS0);
 	}
-	else if (config->ref_voltage == ADC_REF_VOLTAGE_EXTERNAL_AREF)
+	else if (config.ref_voltage == ADC_REF_VOLTAGE_EXTERNAL_AREF)
 	{
 		ADMUX &= ~((1 << REFS1) | (1 << REFS0));
 	}
 
 	// Select input pin
-	if (config->input == ADC_INPUT_0)
+	if (config.input == ADC_INPUT_0)
 	{
 		ADMUX &= ~((1 << MUX0) | (1 << MUX1) | (1 << MUX2) | (1 << MUX3));
 	}
-	else if (config->input == ADC_INPUT_1)
+	else if (config.input == ADC_INPUT_1)
 	{
 		ADMUX &= ~((1 << MUX1) | (1 << MUX2) | (1 << MUX3));
 		ADMUX |= (1 << MUX0);
 	}
-	else if (config->input == ADC_INPUT_2)
+	else if (config.input == ADC_INPUT_2)
 	{
 		ADMUX &= ~((1 << MUX0) | (1 << MUX2) | (1 << MUX3));
 		ADMUX |= (1 << MUX1);
 	}
-	else if (config->input == ADC_INPUT_3)
+	else if (config.input == ADC_INPUT_3)
 	{
 		ADMUX &= ~((1 << MUX2) | (1 << MUX3));
 		ADMUX |= (1 << MUX0) | (1 << MUX1);
 	}
-	else if (config->input == ADC_INPUT_4)
+	else if (config.input == ADC_INPUT_4)
 	{
 		ADMUX &= ~((1 << MUX0) | (1 << MUX1) | (1 << MUX3));
 		ADMUX |= (1 << MUX2);
 	}
-	else if (config->input == ADC_INPUT_5)
+	else if (config.input == ADC_INPUT_5)
 	{
 		ADMUX &= ~((1 << MUX1) | (1 << MUX3));
 		ADMUX |= (1 << MUX0) | (1 << MUX2);
@@ -64,6 +70,11 @@ void adc_init (adc_config_t const * const config)
 	// ADC must be clocked at a frequency between 50 and 200kHz (16MHz/128 = 125KHz)
 	ADCSRA |= (1 << ADPS2) | (1 << ADPS1) | (1 << ADPS0);
 
+	if (config.conversion_callback != NULL)
+	{
+		ADCSRA |= (1 << ADIE);
+	}
+
 	// Enable ADC
 	ADCSRA |= (1 << ADEN);
 
@@ -72,8 +83,8 @@ void adc_init (adc_config_t const * const config)
 
 void adc_deinit ()
 {
-	// Disable ADC
-	ADCSRA &= ~(1 << ADEN);
+	// Disable ADC and its interruption
+	ADCSRA &= ~((1 << ADEN) | (1 << ADIE));
 
 	// Set external AREF as reference voltage by default
 	ADMUX &= ~((1 << REFS1) | (1 << REFS0));
@@ -102,3 +113,16 @@ void adc_read_single_shot (uint16_t * const adc_value)
 
 	return;
 }
+
+void adc_start_conversion ()
+{
+	// The value is passed to 'conversion_callback'
+	ADCSRA |= (1 << ADSC);
+
+	return;
+}
+
+ISR (ADC_vect)
+{
+	config.conversion_callback(ADC);
+}
@@ -8,6 +8,8 @@
 
 #include <stdint.h>
 
+typedef void (*adc_callback_t)(uint16_t adc_value);
+
 typedef enum adc_input
 {
 	ADC_INPUT_0 = 0,	// PC0
@@ -31,12 +33,14 @@ typedef struct adc_config
 {
 	adc_input_t input;
 	adc_ref_voltage_t ref_voltage;
+	adc_callback_t conversion_callback; // May be NULL (Called from the interrupt at the end of 'adc_start_conversion')
 
 } adc_config_t;
 
-void adc_init (adc_config_t const * const config);
+void adc_init (adc_config_t const * const init_config);
 void adc_deinit ();
 
-void adc_read_single_shot (uint16_t * const adc_value);
+void adc_read_single_shot (uint16_t * const adc_value); // Without 'conversion_callback'
+void adc_start_conversion ();
 
 #endif // ADC_H
@@ -64,6 +64,8 @@
 #define PIN_PCINT_D     PIND
 #define PORT_N_PCINT_16 PORTD0
 #define PIN_N_PCINT_16  PIND0
+#define PORT_N_PCINT_19 PORTD3
+#define PIN_N_PCINT_19  PIND3
 #define PORT_N_PCINT_21 PORTD5
 #define PIN_N_PCINT_21  PIND5
 
@@ -59,6 +59,24 @@ void pcint_d_add (pcint_d_pin_config_t const * const config)
         // Enable pin interrupt mask
         PCMSK2 |= (1 << PCINT16);
     }
+    else if (config->pin == PCINT_D_19)
+    {
+        // Set PCINT19 pin as input
+        DDR_PCINT_D &= ~(1 << PORT_N_PCINT_19);
+
+        // Enable / Disable the internal pull-up resistor for PCINT19
+        if (config_array[config->pin].is_pullup_enabled == true)
+        {
+            PORT_PCINT_D |= (1 << PORT_N_PCINT_19);
+        }
+        else
+        {
+            PORT_PCINT_D &= ~(1 << PORT_N_PCINT_19);
+        }
+
+        // Enable pin interrupt mask
+        PCMSK2 |= (1 << PCINT19);
+    }
     else if (config->pin == PCINT_D_21)
     {
         // Set PCINT21 pin as input
@@ -91,6 +109,11 @@ void pcint_d_remove (pcint_d_pin_t pin)
         // Disable pin interrupt mask
         PCMSK2 &= ~(1 << PCINT16);
     }
+    else if (pin == PCINT_D_19)
+    {
+        // Disable pin interrupt mask
+        PCMSK2 &= ~(1 << PCINT19);
+    }
     else if (pin == PCINT_D_21)
     {
         // Disable pin interrupt mask
@@ -169,6 +192,22 @@ ISR (PCINT2_vect)
                     config_array[i].pcint_d_callback(current_state);
                 }
             }
+            else if (config_array[i].pin == PCINT_D_19)
+            {
+                pcint_d_state_t current_state = STATE_D_LOW;
+
+                if ((PIN_PCINT_D & (1 << PIN_N_PCINT_19)) == (1 << PIN_N_PCINT_19))
+                {
+                    current_state = STATE_D_HIGH;
+                }
+
+                if (previous_state_array[i] != current_state)
+                {
+                    previous_state_array[i] = current_state;
+
+                    config_array[i].pcint_d_callback(current_state);
+                }
+            }
             else if (config_array[i].pin == PCINT_D_21)
             {
                 pcint_d_state_t current_state = STATE_D_LOW;
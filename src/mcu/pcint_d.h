@@ -21,6 +21,7 @@ typedef void (*pcint_d_callback_t)(pcint_d_state_t state);
 typedef enum pcint_d_pin
 {
     PCINT_D_16 = 0,
+    PCINT_D_19,
     PCINT_D_21,
     PCINT_D_COUNT
 
@@ -47,7 +47,7 @@ void timer_0_start_in_ctc_mode (timer_0_config_t const * const init_config)
 	}
 
 	// Set timer tick max value -> throw interruption
-	OCR0A = config.prescaler;
+	OCR0A = config.ticks;
 
 	// Set interrupt on compare match
 	TIMSK0 |= (1 << OCIE0A);
@@ -73,6 +73,16 @@ void timer_0_stop ()
 	return;
 }
 
+uint8_t timer_0_get_counter ()
+{
+	return TCNT0;
+}
+
+bool timer_0_is_compare_pending ()
+{
+	return ((TIFR0 & (1 << OCF0A)) != 0U);
+}
+
 ISR (TIMER0_COMPA_vect)
 {
 	config.timer_0_callback();
@@ -7,6 +7,7 @@
 #define TIMER_0_H
 
 #include <stdint.h>
+#include <stdbool.h>
 
 typedef void (*timer_0_callback_t)();
 
@@ -32,4 +33,7 @@ void timer_0_start_in_ctc_mode (timer_0_config_t const * const init_config);
 
 void timer_0_stop ();
 
+uint8_t timer_0_get_counter ();
+bool timer_0_is_compare_pending ();
+
 #endif // TIMER_0_H
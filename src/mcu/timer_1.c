@@ -91,6 +91,11 @@ void timer_1_start (timer_1_config_t const * const init_config)
 	{
 		TIMSK1 |= (1 << OCIE1B);
 	}
+	if ((config.mode == TIMER_1_PWM_MODE) && (config.top_callback != NULL))
+	{
+		// ICR1 is TOP, so its flag is set at TOP
+		TIMSK1 |= (1 << ICIE1);
+	}
 
 	return;
 }
@@ -126,6 +131,60 @@ void timer_1_stop ()
 	return;
 }
 
+void timer_1_set_gpio (bool is_gpio_a_enabled, bool is_gpio_b_enabled)
+{
+	config.is_gpio_a_enabled = is_gpio_a_enabled;
+	config.is_gpio_b_enabled = is_gpio_b_enabled;
+
+	// A disconnected pin goes back to the PORT value (low)
+	if (config.is_gpio_a_enabled == true)
+	{
+		TCCR1A |= (1 << COM1A1);
+		DDR_TIMER1 |= (1 << PIN_TIMER1_OC1A);
+	}
+	else
+	{
+		TCCR1A &= ~((1 << COM1A0) | (1 << COM1A1));
+		PORT_TIMER1 &= ~(1 << PIN_TIMER1_OC1A);
+	}
+
+	if (config.is_gpio_b_enabled == true)
+	{
+		TCCR1A |= (1 << COM1B1);
+		DDR_TIMER1 |= (1 << PIN_TIMER1_OC1B);
+	}
+	else
+	{
+		TCCR1A &= ~((1 << COM1B0) | (1 << COM1B1));
+		PORT_TIMER1 &= ~(1 << PIN_TIMER1_OC1B);
+	}
+
+	return;
+}
+
+uint16_t timer_1_get_counter ()
+{
+	return TCNT1;
+}
+
+bool timer_1_is_overflow_pending ()
+{
+	return ((TIFR1 & (1 << TOV1)) != 0U);
+}
+
+void timer_1_clear_overflow ()
+{
+	// Cleared by writing one
+	TIFR1 = (1 << TOV1);
+
+	return;
+}
+
+bool timer_1_is_top_pending ()
+{
+	return ((TIFR1 & (1 << ICF1)) != 0U);
+}
+
 ISR (TIMER1_OVF_vect)
 {
 	config.overflow_callback();
@@ -140,3 +199,8 @@ ISR (TIMER1_COMPB_vect)
 {
 	config.compare_b_callback();
 }
+
+ISR (TIMER1_CAPT_vect)
+{
+	config.top_callback();
+}
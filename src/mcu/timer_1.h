@@ -46,10 +46,20 @@ typedef struct timer_1_config
 	uint16_t top;
 	bool is_gpio_a_enabled;
 	bool is_gpio_b_enabled;
+	timer_1_callback_t top_callback; // May be NULL (Called at TOP, in the middle of the low output)
 
 } timer_1_config_t;
 
 void timer_1_start (timer_1_config_t const * const init_config);
 void timer_1_stop ();
 
+// PWM mode: the counter keeps running, only the outputs are switched
+void timer_1_set_gpio (bool is_gpio_a_enabled, bool is_gpio_b_enabled);
+
+// PWM mode: the counter and the flags of its turns, the time within a cycle is read from them
+uint16_t timer_1_get_counter ();
+bool timer_1_is_overflow_pending ();	// Set at BOTTOM till it is cleared (the overflow interrupt is off)
+void timer_1_clear_overflow ();
+bool timer_1_is_top_pending ();			// Set at TOP till its interrupt is taken
+
 #endif // TIMER_1_H
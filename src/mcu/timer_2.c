@@ -77,6 +77,9 @@ void timer_2_stop ()
 	// Reset counter register (counter value)
 	TCNT2 = 0U;
 
+	// Drop a pending match, so a restart does not fire at once (cleared by writing one)
+	TIFR2 = (1 << OCF2A) | (1 << OCF2B) | (1 << TOV2);
+
 	return;
 }
 
@@ -0,0 +1,147 @@
+/************************************************************
+ *   Author : German Mundinger
+ *   Date   : 2023
+ ************************************************************/
+
+#include "watchdog.h"
+
+#include <stdint.h>
+#include <assert.h>
+
+#include <avr/io.h>
+#include <avr/interrupt.h>
+#include <avr/wdt.h>
+#include <util/atomic.h>
+
+
+// Pushed by the WDT_vect prologue: r1, r0, SREG and the call-clobbered r18..r27, r30, r31 (the callback may use them).
+// The code is built with optimization, so there is no frame pointer
+#define INTERRUPT_PROLOGUE_SIZE 15U
+#define RETURN_ADDRESS_SIZE     2U  // 16-bit program counter
+
+
+static watchdog_config_t config;
+static volatile uint16_t interrupt_stack_pointer; // In the interrupt, after its prologue
+
+
+static uint8_t watchdog_get_prescaler (watchdog_timeout_t timeout);
+
+void watchdog_start (watchdog_config_t const * const init_config)
+{
+    assert(init_config != NULL);
+    assert(init_config->interrupt_callback != NULL);
+
+    config = *init_config;
+
+    const uint8_t prescaler = watchdog_get_prescaler(config.timeout);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        wdt_reset();
+
+        // WDE can not be cleared while WDRF is set
+        MCUSR &= ~(1 << WDRF);
+
+        // Timed sequence: the new value has to be written within 4 cycles (a set WDIF is not written back, it would clear it)
+        WDTCSR = (WDTCSR & (uint8_t)(~(1 << WDIF))) | (1 << WDCE) | (1 << WDE);
+        WDTCSR = (1 << WDIE) | (1 << WDE) | prescaler;
+    }
+    return;
+}
+
+void watchdog_rearm ()
+{
+    // The hardware clears WDIE when the interrupt is executed, a pending interrupt is kept (writing WDIF back clears it)
+    WDTCSR = (WDTCSR & (uint8_t)(~(1 << WDIF))) | (1 << WDIE);
+
+    return;
+}
+
+void watchdog_disarm ()
+{
+    // WDE stays set, a pending interrupt is kept (writing WDIF back clears it)
+    WDTCSR = WDTCSR & (uint8_t)(~((1 << WDIF) | (1 << WDIE)));
+
+    return;
+}
+
+void watchdog_stop ()
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        wdt_disable();
+    }
+    return;
+}
+
+void watchdog_set_timeout (watchdog_timeout_t timeout)
+{
+    config.timeout = timeout;
+
+    const uint8_t prescaler = watchdog_get_prescaler(config.timeout);
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        // The counter is reset before the prescaler is changed, otherwise the change may reset the MCU
+        wdt_reset();
+
+        const uint8_t interrupt_flag = WDTCSR & (1 << WDIE);
+
+        WDTCSR = (WDTCSR & (uint8_t)(~(1 << WDIF))) | (1 << WDCE) | (1 << WDE);
+        WDTCSR = interrupt_flag | (1 << WDE) | prescaler;
+    }
+    return;
+}
+
+uint16_t watchdog_get_timeout_ms (watchdog_timeout_t timeout)
+{
+    return (uint16_t)(16U << (uint8_t)(timeout));
+}
+
+uint16_t watchdog_get_interrupted_address ()
+{
+    // SP points below the last pushed byte, the return address is above the saved registers: a word address, high byte first
+    uint8_t const * const return_address = (uint8_t const *)(uintptr_t)(interrupt_stack_pointer + 1U + INTERRUPT_PROLOGUE_SIZE);
+
+    const uint16_t word_address = (uint16_t)(((uint16_t)(return_address[0]) << 8U) | (uint16_t)(return_address[1]));
+
+    return (uint16_t)(word_address << 1U);
+}
+
+size_t watchdog_copy_interrupted_stack (uint8_t * const stack_array, size_t stack_array_size)
+{
+    assert(stack_array != NULL);
+
+    const uint16_t stack_pointer = interrupt_stack_pointer + 1U + INTERRUPT_PROLOGUE_SIZE + RETURN_ADDRESS_SIZE;
+    uint8_t const * const stack = (uint8_t const *)(uintptr_t)(stack_pointer);
+    size_t size = 0U;
+
+    // Up to the end of RAM, where the stack starts
+    while ((size < stack_array_size) && ((stack_pointer + size) <= RAMEND))
+    {
+        stack_array[size] = stack[size];
+        ++size;
+    }
+    return size;
+}
+
+
+uint8_t watchdog_get_prescaler (watchdog_timeout_t timeout)
+{
+    // WDP3 is not next to WDP2..0
+    uint8_t prescaler = (uint8_t)(timeout) & 0x07U;
+
+    if (timeout >= WATCHDOG_TIMEOUT_4S)
+    {
+        prescaler |= (1 << WDP3);
+    }
+    return prescaler;
+}
+
+ISR (WDT_vect)
+{
+    // INTERRUPT_PROLOGUE_SIZE registers lie between the stack pointer and the return address
+    interrupt_stack_pointer = SP;
+
+    config.interrupt_callback();
+}
@@ -0,0 +1,58 @@
+/************************************************************
+ *   Author : German Mundinger
+ *   Date   : 2023
+ ************************************************************/
+
+#ifndef WATCHDOG_H
+#define WATCHDOG_H
+
+#include <stdint.h>
+#include <stddef.h>
+
+typedef void (*watchdog_callback_t)();
+
+typedef enum watchdog_timeout
+{
+    WATCHDOG_TIMEOUT_16MS = 0,
+    WATCHDOG_TIMEOUT_32MS,
+    WATCHDOG_TIMEOUT_64MS,
+    WATCHDOG_TIMEOUT_125MS,
+    WATCHDOG_TIMEOUT_250MS,
+    WATCHDOG_TIMEOUT_500MS,
+    WATCHDOG_TIMEOUT_1S,
+    WATCHDOG_TIMEOUT_2S,
+    WATCHDOG_TIMEOUT_4S,
+    WATCHDOG_TIMEOUT_8S
+
+} watchdog_timeout_t;
+
+typedef struct watchdog_config
+{
+    watchdog_timeout_t timeout;
+    watchdog_callback_t interrupt_callback;
+
+} watchdog_config_t;
+
+// Interrupt and system reset mode: a timeout calls back, the next one resets the MCU unless it is rearmed.
+// The watchdog oscillator keeps running in power-down, so the interrupt wakes up the MCU.
+// An interrupt held off by a cleared I-bit never calls back, so the MCU is not reset either
+void watchdog_start (watchdog_config_t const * const init_config);
+void watchdog_rearm ();
+void watchdog_stop ();
+
+// System reset mode until it is rearmed: the next timeout resets the MCU, even with interrupts disabled
+void watchdog_disarm ();
+
+// Restarts the watchdog counter, the interrupt stays armed or disarmed
+void watchdog_set_timeout (watchdog_timeout_t timeout);
+
+// 2K cycles of the 128 kHz oscillator and its powers of 2 (16 ms ... 8192 ms)
+uint16_t watchdog_get_timeout_ms (watchdog_timeout_t timeout);
+
+// The byte address of the code the last interrupt has stopped, to find a hang (look it up in the listing)
+uint16_t watchdog_get_interrupted_address ();
+
+// The stack of that code, to find its callers: their return addresses are word addresses, high byte first
+size_t watchdog_copy_interrupted_stack (uint8_t * const stack_array, size_t stack_array_size);
+
+#endif // WATCHDOG_H
\ No newline at end of file
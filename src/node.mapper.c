@@ -6,7 +6,8 @@
 #include "node.mapper.h"
 
 #include <stdbool.h>
-#include <stdio.h>
+#include <stdint.h>
+#include <string.h>
 #include <assert.h>
 
 #include "lwjson/lwjson.h"
@@ -14,129 +15,1089 @@
 #include "node/node.types.h"
 
 #include "std_error/std_error.h"
+#include "logger.h"
 
 
 #define FILE_NAME           "node.mapper.c"
 #define DEFAULT_ERROR_TEXT  "Mapper error"
+#define OVERFLOW_ERROR_TEXT "Mapper overflow"
+#define BINARY_ERROR_TEXT   "Mapper binary error"
+#define STREAM_ERROR_TEXT   "Mapper stream error"
 
+#define BINARY_HEADER_SIZE  2U // Type + length
+#define BINARY_REQUEST_FLAG 0x80U // In the command byte: a request id follows (commands are below 0x80)
+#define SINK_CHUNK_SIZE     16U // Serialized data is passed on in chunks of this size
 
-void node_mapper_serialize_message (node_msg_t const * const msg, char *raw_data, size_t * const raw_data_size)
+#define ARRAY_SIZE(array) (sizeof(array) / sizeof((array)[0]))
+#define UNUSED(x) (void)(x)
+
+
+typedef struct node_mapper_writer
+{
+    char *buffer;
+    size_t capacity;
+    size_t size;
+    bool is_overflow;
+
+    node_mapper_sink_callback_t sink_callback; // Takes the buffer every time it is full (optional)
+    size_t sink_size;                          // Bytes already taken by the sink
+
+} node_mapper_writer_t;
+
+typedef enum node_mapper_stream_state
+{
+    STREAM_WAITING_STATE = 0,   // Between messages
+    STREAM_JSON_STATE,
+    STREAM_BINARY_STATE,
+    STREAM_SKIPPING_STATE       // Inside a binary message, which is too long
+
+} node_mapper_stream_state_t;
+
+typedef struct node_mapper_reader
+{
+    const uint8_t *buffer;
+    size_t size;
+    size_t position;
+    bool is_underflow;
+
+} node_mapper_reader_t;
+
+typedef struct node_mapper_text_format
+{
+    int32_t divisor;        // Drops the stored fraction digits, which are not printed
+    size_t fraction_size;   // Printed fraction digits
+
+} node_mapper_text_format_t;
+
+
+
+
+static node_mapper_stream_config_t stream_config;
+static node_mapper_stream_state_t stream_state;
+static lwjson_stream_parser_t json_stream_parser;
+static node_msg_t stream_msg;
+static node_mapper_mask_t stream_dest_mask;
+static uint16_t stream_request_id;
+static char binary_stream_buffer[NODE_MAPPER_BINARY_MAX_SIZE];
+static size_t binary_stream_size;
+static size_t skip_stream_size;
+
+
+static void node_mapper_process_json_stream (lwjson_stream_parser_t *parser, lwjson_stream_type_t type);
+static int node_mapper_process_binary_stream (char byte, std_error_t * const error);
+static void node_mapper_dispatch_stream_msg (node_mapper_format_t format);
+static int32_t node_mapper_parse_decimal (const char *text, size_t text_capacity, size_t fraction_size);
+static uint32_t node_mapper_parse_unsigned (const char *text, size_t text_capacity);
+
+static int node_mapper_read_binary_message (const char *raw_data, size_t raw_data_size, node_msg_t * const msg, node_mapper_mask_t * const dest_mask, uint16_t * const request_id, std_error_t * const error);
+#ifdef NODE_MASK_ADDRESSING
+static node_mapper_mask_t node_mapper_get_dest_mask (node_msg_t const * const msg);
+#endif // NODE_MASK_ADDRESSING
+static void node_mapper_set_dest_array (node_msg_t * const msg, node_mapper_mask_t dest_mask);
+
+static void node_mapper_write_json_header (node_mapper_writer_t * const writer, node_msg_t const * const msg);
+static void node_mapper_write_json_message (node_mapper_writer_t * const writer, node_msg_t const * const msg);
+static void node_mapper_write_binary_header (node_mapper_writer_t * const writer, node_msg_t const * const msg);
+static void node_mapper_write_history (node_mapper_writer_t * const writer, node_msg_t const * const msg, node_mapper_history_t const * const history, uint32_t time, node_mapper_format_t format);
+static void node_mapper_write_samples (node_mapper_writer_t * const writer, node_mapper_history_t const * const history, uint32_t time, node_mapper_format_t format, node_mapper_text_format_t const * const text_format_array);
+static void node_mapper_skip_chunk (const char *chunk, size_t chunk_size);
+
+static void node_mapper_write_char (node_mapper_writer_t * const writer, char symbol);
+static void node_mapper_write_text (node_mapper_writer_t * const writer, const char *text);
+static void node_mapper_write_integer (node_mapper_writer_t * const writer, int32_t value);
+static void node_mapper_write_unsigned (node_mapper_writer_t * const writer, uint32_t value);
+static void node_mapper_write_decimal (node_mapper_writer_t * const writer, int32_t value, size_t fraction_size);
+static void node_mapper_write_varint (node_mapper_writer_t * const writer, uint32_t value);
+static void node_mapper_write_zigzag (node_mapper_writer_t * const writer, int32_t value);
+
+static uint8_t node_mapper_read_byte (node_mapper_reader_t * const reader);
+static uint32_t node_mapper_read_varint (node_mapper_reader_t * const reader);
+static int32_t node_mapper_read_zigzag (node_mapper_reader_t * const reader);
+
+// Keys and per-command data are generated from the message schema
+#include "node.mapper.schema.h"
+
+node_mapper_format_t node_mapper_get_format (const char *raw_data, size_t raw_data_size)
+{
+    assert(raw_data != NULL);
+
+    if ((raw_data_size != 0U) && ((uint8_t)(raw_data[0]) == NODE_MAPPER_BINARY_TYPE))
+    {
+        return NODE_MAPPER_BINARY_FORMAT;
+    }
+    return NODE_MAPPER_JSON_FORMAT;
+}
+
+int node_mapper_serialize_message (node_msg_t const * const msg, char *raw_data, size_t raw_data_capacity, size_t * const raw_data_size, std_error_t * const error)
+{
+    assert(raw_data         != NULL);
+    assert(msg              != NULL);
+    assert(raw_data_size    != NULL);
+    assert(raw_data_capacity            != 0U);
+    assert(msg->header.dest_array_size  != 0U);
+
+    node_mapper_writer_t writer;
+    writer.buffer        = raw_data;
+    writer.capacity      = raw_data_capacity - 1U; // Keep space for the terminating null
+    writer.size          = 0U;
+    writer.is_overflow   = false;
+    writer.sink_callback = NULL;
+    writer.sink_size     = 0U;
+
+    node_mapper_write_json_message(&writer, msg);
+
+    raw_data[writer.size] = '\0';
+    *raw_data_size = writer.size;
+
+    if (writer.is_overflow == true)
+    {
+        *raw_data_size = 0U;
+
+        std_error_catch_custom(error, (int)writer.size, OVERFLOW_ERROR_TEXT, FILE_NAME, __LINE__);
+
+        return STD_FAILURE;
+    }
+
+    return STD_SUCCESS;
+}
+
+int node_mapper_serialize_binary_message (node_msg_t const * const msg, char *raw_data, size_t raw_data_capacity, size_t * const raw_data_size, std_error_t * const error)
 {
     assert(raw_data         != NULL);
     assert(msg              != NULL);
     assert(raw_data_size    != NULL);
     assert(msg->header.dest_array_size  != 0U);
 
-    char dest_array[16] = { '\0' };
+    node_mapper_writer_t writer;
+    writer.buffer        = raw_data;
+    writer.capacity      = raw_data_capacity;
+    writer.size          = 0U;
+    writer.is_overflow   = false;
+    writer.sink_callback = NULL;
+    writer.sink_size     = 0U;
+
+    node_mapper_write_char(&writer, (char)NODE_MAPPER_BINARY_TYPE);
+    node_mapper_write_char(&writer, '\0'); // Length placeholder
+
+    node_mapper_write_binary_header(&writer, msg);
+
+    if (node_mapper_is_command_known(msg) == true)
+    {
+        node_mapper_write_char(&writer, (char)msg->cmd_id);
+        node_mapper_write_binary_data(&writer, msg);
+    }
+    else
+    {
+        node_mapper_write_char(&writer, (char)DO_NOTHING);
+    }
+
+    const bool is_too_long = (writer.size - BINARY_HEADER_SIZE) > UINT8_MAX;
+
+    if ((writer.is_overflow == true) || (is_too_long == true))
+    {
+        *raw_data_size = 0U;
+
+        std_error_catch_custom(error, (int)writer.size, OVERFLOW_ERROR_TEXT, FILE_NAME, __LINE__);
+
+        return STD_FAILURE;
+    }
+
+    raw_data[1] = (char)(writer.size - BINARY_HEADER_SIZE);
+    *raw_data_size = writer.size;
+
+    return STD_SUCCESS;
+}
+
+int node_mapper_deserialize_binary_message (const char *raw_data, size_t raw_data_size, node_msg_t * const msg, std_error_t * const error)
+{
+    assert(raw_data != NULL);
+    assert(msg      != NULL);
+
+    node_mapper_mask_t dest_mask;
+    uint16_t request_id;
+
+    if (node_mapper_read_binary_message(raw_data, raw_data_size, msg, &dest_mask, &request_id, error) != STD_SUCCESS)
+    {
+        return STD_FAILURE;
+    }
+    node_mapper_set_dest_array(msg, dest_mask);
+
+    return STD_SUCCESS;
+}
 
-    sprintf(dest_array, "%d", msg->header.dest_array[0]);
+int node_mapper_serialize_stream (node_msg_t const * const msg, node_mapper_format_t format, node_mapper_sink_callback_t sink_callback, std_error_t * const error)
+{
+    assert(msg              != NULL);
+    assert(sink_callback    != NULL);
+    assert(msg->header.dest_array_size  != 0U);
 
-    for (size_t i = 1U; i < msg->header.dest_array_size; ++i)
+    if (format == NODE_MAPPER_BINARY_FORMAT)
     {
-        sprintf(dest_array + strlen(dest_array), ",%d", msg->header.dest_array[i]);
+        // The length goes first, so a binary message is completed before it is passed on
+        char raw_data[NODE_MAPPER_BINARY_MAX_SIZE];
+        size_t raw_data_size;
+
+        if (node_mapper_serialize_binary_message(msg, raw_data, ARRAY_SIZE(raw_data), &raw_data_size, error) != STD_SUCCESS)
+        {
+            return STD_FAILURE;
+        }
+        sink_callback(raw_data, raw_data_size);
+
+        return STD_SUCCESS;
     }
 
-    int data_size = (-1);
+    char chunk[SINK_CHUNK_SIZE];
 
-    if ((msg->cmd_id == SET_MODE) || (msg->cmd_id == SET_LIGHT))
+    node_mapper_writer_t writer;
+    writer.buffer        = chunk;
+    writer.capacity      = ARRAY_SIZE(chunk);
+    writer.size          = 0U;
+    writer.is_overflow   = false;
+    writer.sink_callback = sink_callback;
+    writer.sink_size     = 0U;
+
+    node_mapper_write_json_message(&writer, msg);
+
+    if (writer.size != 0U)
     {
-        data_size = sprintf(raw_data, "{\"src_id\":%d,\"dst_id\":[%s],\"cmd_id\":%d,\"data\":{\"mode_id\":%ld}}", msg->header.source, dest_array, msg->cmd_id, msg->value_0);
+        sink_callback(writer.buffer, writer.size);
     }
-    else if (msg->cmd_id == UPDATE_TEMPERATURE)
+
+    return STD_SUCCESS;
+}
+
+void node_mapper_clear_history (node_mapper_history_t * const history)
+{
+    assert(history != NULL);
+
+    history->first_index    = 0U;
+    history->size           = 0U;
+
+    return;
+}
+
+void node_mapper_push_sample (node_mapper_history_t * const history, node_mapper_sample_t const * const sample)
+{
+    assert(history  != NULL);
+    assert(sample   != NULL);
+
+    size_t last_index = history->first_index + history->size;
+
+    if (last_index >= ARRAY_SIZE(history->sample_array))
     {
-        const int int_part = (int)msg->value_1;
-        const int float_part = (int)((msg->value_1 - (float)(int_part)) * 10.0F);
+        last_index -= ARRAY_SIZE(history->sample_array);
+    }
+    history->sample_array[last_index] = *sample;
 
-        data_size = sprintf(raw_data, "{\"src_id\":%d,\"dst_id\":[%s],\"cmd_id\":%d,\"data\":{\"pres_hpa\":%ld,\"temp_c\":%d.%d}}", msg->header.source, dest_array, msg->cmd_id, msg->value_0, int_part, float_part);
+    if (history->size < ARRAY_SIZE(history->sample_array))
+    {
+        ++history->size;
     }
     else
     {
-        data_size = sprintf(raw_data, "{\"src_id\":%d,\"dst_id\":[%s],\"cmd_id\":%d}", msg->header.source, dest_array, DO_NOTHING);
+        // Full: the oldest sample is overwritten
+        ++history->first_index;
+
+        if (history->first_index == ARRAY_SIZE(history->sample_array))
+        {
+            history->first_index = 0U;
+        }
+    }
+    return;
+}
+
+void node_mapper_drop_samples (node_mapper_history_t * const history, size_t sample_count)
+{
+    assert(history != NULL);
+
+    if (sample_count >= history->size)
+    {
+        node_mapper_clear_history(history);
+
+        return;
     }
 
-    *raw_data_size = 0U;
+    history->first_index += sample_count;
 
-    if (data_size > 0)
+    if (history->first_index >= ARRAY_SIZE(history->sample_array))
     {
-        *raw_data_size = (size_t)data_size;
+        history->first_index -= ARRAY_SIZE(history->sample_array);
     }
+    history->size -= sample_count;
 
     return;
 }
 
-int node_mapper_deserialize_message (const char *raw_data, node_msg_t * const msg, std_error_t * const error)
+int node_mapper_serialize_history_stream (node_msg_t const * const msg, node_mapper_history_t const * const history, uint32_t time, node_mapper_format_t format, node_mapper_sink_callback_t sink_callback, std_error_t * const error)
 {
-    assert(raw_data != NULL);
-    assert(msg      != NULL);
+    assert(msg              != NULL);
+    assert(history          != NULL);
+    assert(sink_callback    != NULL);
+    assert(msg->header.dest_array_size  != 0U);
+    assert((int)(msg->cmd_id)           == NODE_MAPPER_HISTORY_CMD_ID);
 
-    msg->header.dest_array_size = 0U;
+    char chunk[SINK_CHUNK_SIZE];
 
-    int exit_code = STD_SUCCESS;
+    node_mapper_writer_t writer;
+    writer.buffer        = chunk;
+    writer.capacity      = ARRAY_SIZE(chunk);
+    writer.size          = 0U;
+    writer.is_overflow   = false;
+    writer.sink_callback = node_mapper_skip_chunk;
+    writer.sink_size     = 0U;
 
-    static lwjson_t lwjson;
-    static lwjson_token_t tokens[8];
+    if (format == NODE_MAPPER_BINARY_FORMAT)
+    {
+        // The length goes first, so the history is measured by a dry run instead of being kept in RAM twice
+        node_mapper_write_history(&writer, msg, history, time, format);
 
-    lwjson_init(&lwjson, tokens, LWJSON_ARRAYSIZE(tokens));
+        const size_t history_size = writer.sink_size + writer.size;
 
-    lwjsonr_t parser_code = lwjson_parse(&lwjson, raw_data);
+        if (history_size > UINT8_MAX)
+        {
+            std_error_catch_custom(error, (int)history_size, OVERFLOW_ERROR_TEXT, FILE_NAME, __LINE__);
+
+            return STD_FAILURE;
+        }
 
-    if (parser_code == lwjsonOK)
+        writer.size      = 0U;
+        writer.sink_size = 0U;
+
+        node_mapper_write_char(&writer, (char)NODE_MAPPER_BINARY_TYPE);
+        node_mapper_write_char(&writer, (char)history_size);
+    }
+    writer.sink_callback = sink_callback;
+
+    node_mapper_write_history(&writer, msg, history, time, format);
+
+    if (writer.size != 0U)
     {
-        const lwjson_token_t *token;
+        sink_callback(writer.buffer, writer.size);
+    }
+
+    return STD_SUCCESS;
+}
+
+void node_mapper_init_stream (node_mapper_stream_config_t const * const init_config)
+{
+    assert(init_config != NULL);
+    assert(init_config->msg_callback != NULL);
+
+    stream_config = *init_config;
+
+    lwjson_stream_init(&json_stream_parser, node_mapper_process_json_stream);
+
+    node_mapper_reset_stream();
+
+    return;
+}
 
-        bool is_token_parsed = ((token = lwjson_find(&lwjson, "src_id")) != NULL) && (token->type == LWJSON_TYPE_NUM_INT);
+void node_mapper_reset_stream ()
+{
+    stream_state        = STREAM_WAITING_STATE;
+    binary_stream_size  = 0U;
+    skip_stream_size    = 0U;
+
+    return;
+}
+
+int node_mapper_parse_stream (const char *chunk, size_t chunk_size, std_error_t * const error)
+{
+    assert(chunk != NULL);
+
+    int exit_code = STD_SUCCESS;
 
-        if (is_token_parsed == true)
+    for (size_t i = 0U; i < chunk_size; ++i)
+    {
+        const char byte = chunk[i];
+
+        if (stream_state == STREAM_WAITING_STATE)
         {
-            msg->header.source = (node_id_t)token->u.num_int;
+            if (byte == '{')
+            {
+                lwjson_stream_reset(&json_stream_parser);
+
+                stream_msg.header.dest_array_size   = 0U;
+                stream_msg.cmd_id                   = DO_NOTHING;
+                stream_msg.value_0                  = 0L;
+                stream_dest_mask                    = 0U;
+                stream_request_id                   = NODE_MAPPER_NO_REQUEST_ID;
+
+                stream_state = STREAM_JSON_STATE;
+            }
+            else if ((uint8_t)(byte) == NODE_MAPPER_BINARY_TYPE)
+            {
+                binary_stream_size = 0U;
+
+                stream_state = STREAM_BINARY_STATE;
+            }
+            else
+            {
+                continue; // Separators and garbage between messages
+            }
         }
 
-        is_token_parsed = ((token = lwjson_find(&lwjson, "dst_id")) != NULL) && (token->type == LWJSON_TYPE_ARRAY);
+        if (stream_state == STREAM_JSON_STATE)
+        {
+            const lwjsonr_t parser_code = lwjson_stream_parse(&json_stream_parser, byte);
+
+            if ((parser_code == lwjsonSTREAMDONE) && (node_mapper_is_data_valid(&stream_msg) == true))
+            {
+                stream_state = STREAM_WAITING_STATE;
 
-        if (is_token_parsed == true)
+                node_mapper_dispatch_stream_msg(NODE_MAPPER_JSON_FORMAT);
+            }
+            else if ((parser_code != lwjsonSTREAMINPROG) && (parser_code != lwjsonOK))
+            {
+                stream_state = STREAM_WAITING_STATE;
+
+                std_error_catch_custom(error, (int)parser_code, STREAM_ERROR_TEXT, FILE_NAME, __LINE__);
+
+                exit_code = STD_FAILURE;
+            }
+        }
+        else if (stream_state == STREAM_BINARY_STATE)
+        {
+            if (node_mapper_process_binary_stream(byte, error) != STD_SUCCESS)
+            {
+                exit_code = STD_FAILURE;
+            }
+        }
+        else if (stream_state == STREAM_SKIPPING_STATE)
         {
-            for (const lwjson_token_t *tkn = lwjson_get_first_child(token); tkn != NULL; tkn = tkn->next)
+            --skip_stream_size;
+
+            if (skip_stream_size == 0U)
             {
-                msg->header.dest_array[msg->header.dest_array_size] = (node_id_t)tkn->u.num_int;
-                ++msg->header.dest_array_size;
+                stream_state = STREAM_WAITING_STATE;
             }
         }
+    }
+    return exit_code;
+}
+
+void node_mapper_process_json_stream (lwjson_stream_parser_t *parser, lwjson_stream_type_t type)
+{
+    // Keys stay on the stack: [0] root object, [1] root key, [2] array or nested object, [3] nested key
+    const size_t depth = parser->stack_pos;
+
+    if ((type != LWJSON_STREAM_TYPE_NUMBER) || (depth < 2U) || (parser->stack[1].type != LWJSON_STREAM_TYPE_KEY))
+    {
+        return;
+    }
+
+    const char *root_name = parser->stack[1].meta.name;
+    const node_mapper_key_t root_key = node_mapper_get_key(root_name, strlen(root_name));
+    if ((depth == 2U) && (root_key == DST_MASK_KEY))
+    {
+        // All 32 bits are used, it does not fit the signed parse
+        stream_dest_mask |= (node_mapper_mask_t)node_mapper_parse_unsigned(parser->data.prim.buff, ARRAY_SIZE(parser->data.prim.buff));
+    }
+    else if (depth == 2U)
+    {
+        const int32_t value = node_mapper_parse_decimal(parser->data.prim.buff, ARRAY_SIZE(parser->data.prim.buff), 0U);
+
+        if (root_key == SRC_ID_KEY)
+        {
+            stream_msg.header.source = (node_id_t)value;
+        }
+        else if (root_key == CMD_ID_KEY)
+        {
+            stream_msg.cmd_id = (node_command_id_t)value;
+        }
+        else if (root_key == REQ_ID_KEY)
+        {
+            stream_request_id = (uint16_t)value;
+        }
+    }
+    else if ((depth == 3U) && (root_key == DST_ID_KEY) && (parser->stack[2].type == LWJSON_STREAM_TYPE_ARRAY))
+    {
+        const int32_t value = node_mapper_parse_decimal(parser->data.prim.buff, ARRAY_SIZE(parser->data.prim.buff), 0U);
+
+        if ((value >= 0) && (value < 32))
+        {
+            stream_dest_mask |= NODE_MAPPER_NODE_BIT(value);
+        }
+        else
+        {
+            LOG("Mapper: dst_id %ld is out of the mask\r\n", (long)value);
+        }
+    }
+    else if ((depth == 4U) && (root_key == DATA_KEY) && (parser->stack[3].type == LWJSON_STREAM_TYPE_KEY))
+    {
+        const char *data_name = parser->stack[3].meta.name;
+        const node_mapper_key_t data_key = node_mapper_get_key(data_name, strlen(data_name));
+
+        node_mapper_set_json_field(&stream_msg, data_key, parser->data.prim.buff, ARRAY_SIZE(parser->data.prim.buff));
+    }
+    return;
+}
+
+int node_mapper_process_binary_stream (char byte, std_error_t * const error)
+{
+    binary_stream_buffer[binary_stream_size] = byte;
+    ++binary_stream_size;
+
+    if (binary_stream_size < BINARY_HEADER_SIZE)
+    {
+        return STD_SUCCESS;
+    }
+
+    const size_t msg_size = (size_t)((uint8_t)(binary_stream_buffer[1])) + BINARY_HEADER_SIZE;
+
+    if (msg_size > ARRAY_SIZE(binary_stream_buffer))
+    {
+        skip_stream_size = msg_size - binary_stream_size;
+        stream_state = STREAM_SKIPPING_STATE;
+
+        std_error_catch_custom(error, (int)msg_size, OVERFLOW_ERROR_TEXT, FILE_NAME, __LINE__);
+
+        return STD_FAILURE;
+    }
+
+    if (binary_stream_size == msg_size)
+    {
+        stream_state = STREAM_WAITING_STATE;
+
+        if (node_mapper_read_binary_message(binary_stream_buffer, binary_stream_size, &stream_msg, &stream_dest_mask, &stream_request_id, error) != STD_SUCCESS)
+        {
+            return STD_FAILURE;
+        }
+        node_mapper_dispatch_stream_msg(NODE_MAPPER_BINARY_FORMAT);
+    }
+    return STD_SUCCESS;
+}
+
+void node_mapper_dispatch_stream_msg (node_mapper_format_t format)
+{
+    // A single bit test instead of a search through the destination list
+    if ((stream_dest_mask & stream_config.node_mask) == 0U)
+    {
+        return;
+    }
+    node_mapper_set_dest_array(&stream_msg, stream_dest_mask);
+
+    stream_config.msg_callback(&stream_msg, format, stream_request_id);
+
+    return;
+}
+
+int32_t node_mapper_parse_decimal (const char *text, size_t text_capacity, size_t fraction_size)
+{
+    // Fixed-point: "23.4" with 2 fraction digits is 2340, extra fraction digits are dropped
+    bool is_negative = false;
+    bool is_fraction = false;
+    size_t i = 0U;
+
+    if (text[0] == '-')
+    {
+        is_negative = true;
+        ++i;
+    }
+
+    int32_t value = 0;
+
+    for (; i < text_capacity; ++i)
+    {
+        if ((text[i] == '.') && (is_fraction == false))
+        {
+            is_fraction = true;
+        }
+        else if ((text[i] < '0') || (text[i] > '9'))
+        {
+            break;
+        }
+        else if (is_fraction == false)
+        {
+            value = (value * 10) + (int32_t)(text[i] - '0');
+        }
+        else if (fraction_size != 0U)
+        {
+            value = (value * 10) + (int32_t)(text[i] - '0');
+            --fraction_size;
+        }
+    }
+
+    for (; fraction_size != 0U; --fraction_size)
+    {
+        value *= 10;
+    }
+
+    if (is_negative == true)
+    {
+        value = -value;
+    }
+    return value;
+}
+
+uint32_t node_mapper_parse_unsigned (const char *text, size_t text_capacity)
+{
+    uint32_t value = 0UL;
+
+    for (size_t i = 0U; (i < text_capacity) && (text[i] >= '0') && (text[i] <= '9'); ++i)
+    {
+        value = (value * 10UL) + (uint32_t)(text[i] - '0');
+    }
+    return value;
+}
+
+int node_mapper_read_binary_message (const char *raw_data, size_t raw_data_size, node_msg_t * const msg, node_mapper_mask_t * const dest_mask, uint16_t * const request_id, std_error_t * const error)
+{
+    msg->header.dest_array_size = 0U;
+    msg->cmd_id                 = DO_NOTHING;
+    *dest_mask                  = 0U;
+    *request_id                 = NODE_MAPPER_NO_REQUEST_ID;
+
+    node_mapper_reader_t reader;
+    reader.buffer       = (const uint8_t*)raw_data;
+    reader.size         = raw_data_size;
+    reader.position     = 0U;
+    reader.is_underflow = false;
+
+    const uint8_t type = node_mapper_read_byte(&reader);
+    const uint8_t length = node_mapper_read_byte(&reader);
+
+    if ((type != NODE_MAPPER_BINARY_TYPE) || (((size_t)length + BINARY_HEADER_SIZE) > raw_data_size))
+    {
+        std_error_catch_custom(error, (int)type, BINARY_ERROR_TEXT, FILE_NAME, __LINE__);
+
+        return STD_FAILURE;
+    }
+    reader.size = (size_t)length + BINARY_HEADER_SIZE;
+
+    msg->header.source = (node_id_t)node_mapper_read_varint(&reader);
+
+    // Either a list of destination ids or no list and a destination mask
+    const uint32_t dest_count = node_mapper_read_varint(&reader);
+
+    if (dest_count == 0U)
+    {
+        *dest_mask = (node_mapper_mask_t)node_mapper_read_varint(&reader);
+    }
 
-        is_token_parsed = ((token = lwjson_find(&lwjson, "cmd_id")) != NULL) && (token->type == LWJSON_TYPE_NUM_INT);
+    for (uint32_t i = 0U; (i < dest_count) && (reader.is_underflow == false); ++i)
+    {
+        const uint32_t dest_id = node_mapper_read_varint(&reader);
 
-        if (is_token_parsed == true)
+        if (dest_id < 32U)
         {
-            msg->cmd_id = (node_command_id_t)token->u.num_int;
+            *dest_mask |= NODE_MAPPER_NODE_BIT(dest_id);
         }
         else
         {
-            msg->cmd_id = DO_NOTHING;
+            LOG("Mapper: dst_id %lu is out of the mask\r\n", (unsigned long)dest_id);
+        }
+    }
+
+    const uint8_t cmd_byte = node_mapper_read_byte(&reader);
+
+    msg->cmd_id = (node_command_id_t)(cmd_byte & (uint8_t)(~BINARY_REQUEST_FLAG));
+
+    if ((cmd_byte & BINARY_REQUEST_FLAG) != 0U)
+    {
+        *request_id = (uint16_t)node_mapper_read_varint(&reader);
+    }
+
+    // The fields fill their halves of the value, the rest must not keep a previous message
+    msg->value_0 = 0L;
+
+    node_mapper_read_binary_data(&reader, msg);
+
+    if ((reader.is_underflow == true) || (node_mapper_is_data_valid(msg) == false))
+    {
+        msg->cmd_id = DO_NOTHING;
+        *dest_mask  = 0U;
+
+        std_error_catch_custom(error, (int)reader.position, BINARY_ERROR_TEXT, FILE_NAME, __LINE__);
+
+        return STD_FAILURE;
+    }
+
+    return STD_SUCCESS;
+}
+
+#ifdef NODE_MASK_ADDRESSING
+node_mapper_mask_t node_mapper_get_dest_mask (node_msg_t const * const msg)
+{
+    node_mapper_mask_t dest_mask = 0U;
+
+    for (size_t i = 0U; i < msg->header.dest_array_size; ++i)
+    {
+        dest_mask |= NODE_MAPPER_NODE_BIT(msg->header.dest_array[i]);
+    }
+    return dest_mask;
+}
+#endif // NODE_MASK_ADDRESSING
+
+void node_mapper_set_dest_array (node_msg_t * const msg, node_mapper_mask_t dest_mask)
+{
+    msg->header.dest_array_size = 0U;
+
+    for (uint32_t id = 0U; (dest_mask != 0U) && (msg->header.dest_array_size < ARRAY_SIZE(msg->header.dest_array)); ++id)
+    {
+        if ((dest_mask & 1U) != 0U)
+        {
+            msg->header.dest_array[msg->header.dest_array_size] = (node_id_t)id;
+            ++msg->header.dest_array_size;
         }
+        dest_mask >>= 1U;
+    }
+    return;
+}
+
+void node_mapper_write_json_header (node_mapper_writer_t * const writer, node_msg_t const * const msg)
+{
+    node_mapper_write_text(writer, "{\"src_id\":");
+    node_mapper_write_integer(writer, (int32_t)msg->header.source);
+
+#ifdef NODE_MASK_ADDRESSING
+    node_mapper_write_text(writer, ",\"dst_mask\":");
+    node_mapper_write_unsigned(writer, node_mapper_get_dest_mask(msg));
+    node_mapper_write_text(writer, ",\"cmd_id\":");
+#else
+    node_mapper_write_text(writer, ",\"dst_id\":[");
+
+    for (size_t i = 0U; i < msg->header.dest_array_size; ++i)
+    {
+        if (i != 0U)
+        {
+            node_mapper_write_char(writer, ',');
+        }
+        node_mapper_write_integer(writer, (int32_t)msg->header.dest_array[i]);
+    }
+
+    node_mapper_write_text(writer, "],\"cmd_id\":");
+#endif // NODE_MASK_ADDRESSING
+
+    return;
+}
+
+void node_mapper_write_json_message (node_mapper_writer_t * const writer, node_msg_t const * const msg)
+{
+    node_mapper_write_json_header(writer, msg);
+
+    if (node_mapper_is_command_known(msg) == true)
+    {
+        node_mapper_write_integer(writer, (int32_t)msg->cmd_id);
+        node_mapper_write_json_data(writer, msg);
+    }
+    else
+    {
+        node_mapper_write_integer(writer, (int32_t)DO_NOTHING);
+    }
+    node_mapper_write_char(writer, '}');
+
+    return;
+}
+
+void node_mapper_write_binary_header (node_mapper_writer_t * const writer, node_msg_t const * const msg)
+{
+    node_mapper_write_varint(writer, (uint32_t)msg->header.source);
+
+#ifdef NODE_MASK_ADDRESSING
+    node_mapper_write_varint(writer, 0U); // No destination list, a mask follows
+    node_mapper_write_varint(writer, node_mapper_get_dest_mask(msg));
+#else
+    node_mapper_write_varint(writer, (uint32_t)msg->header.dest_array_size);
 
-        if ((msg->cmd_id == SET_MODE) || (msg->cmd_id == SET_LIGHT))
+    for (size_t i = 0U; i < msg->header.dest_array_size; ++i)
+    {
+        node_mapper_write_varint(writer, (uint32_t)msg->header.dest_array[i]);
+    }
+#endif // NODE_MASK_ADDRESSING
+
+    return;
+}
+
+void node_mapper_write_history (node_mapper_writer_t * const writer, node_msg_t const * const msg, node_mapper_history_t const * const history, uint32_t time, node_mapper_format_t format)
+{
+    if (format == NODE_MAPPER_BINARY_FORMAT)
+    {
+        node_mapper_write_binary_header(writer, msg);
+        node_mapper_write_char(writer, (char)msg->cmd_id);
+    }
+    else
+    {
+        node_mapper_write_json_header(writer, msg);
+        node_mapper_write_integer(writer, (int32_t)msg->cmd_id);
+    }
+
+    node_mapper_write_samples_data(writer, msg, history, time, format);
+
+    if (format != NODE_MAPPER_BINARY_FORMAT)
+    {
+        node_mapper_write_char(writer, '}');
+    }
+    return;
+}
+
+void node_mapper_write_samples (node_mapper_writer_t * const writer, node_mapper_history_t const * const history, uint32_t time, node_mapper_format_t format, node_mapper_text_format_t const * const text_format_array)
+{
+    // The oldest sample goes with its age and its values, every next one with deltas only,
+    // so slowly changing readings take about a byte per value.
+    // JSON carries the values in the text format of their keys (as in the command of the fields), so the deltas are
+    // taken between the printed values
+    node_mapper_sample_t const *prev_sample = NULL;
+    size_t index = history->first_index;
+
+    for (size_t i = 0U; i < history->size; ++i)
+    {
+        node_mapper_sample_t const * const sample = &history->sample_array[index];
+
+        uint32_t time_delta = time - sample->time;
+
+        if (prev_sample != NULL)
         {
-            is_token_parsed = ((token = lwjson_find(&lwjson, "data")) != NULL) && (token->type == LWJSON_TYPE_OBJECT);
+            time_delta = sample->time - prev_sample->time;
+        }
 
-            if (is_token_parsed == true)
+        if (format == NODE_MAPPER_BINARY_FORMAT)
+        {
+            node_mapper_write_varint(writer, time_delta);
+        }
+        else
+        {
+            if (prev_sample != NULL)
             {
-                const lwjson_token_t *tkn = lwjson_find_ex(&lwjson, token, "mode_id");
+                node_mapper_write_char(writer, ',');
+            }
+            node_mapper_write_integer(writer, (int32_t)time_delta);
+        }
 
-                is_token_parsed = (tkn!= NULL) && (tkn->type == LWJSON_TYPE_NUM_INT);
+        for (size_t j = 0U; j < ARRAY_SIZE(sample->value_array); ++j)
+        {
+            if (format == NODE_MAPPER_BINARY_FORMAT)
+            {
+                int32_t value_delta = sample->value_array[j];
 
-                if (is_token_parsed == true)
+                if (prev_sample != NULL)
                 {
-                    msg->value_0 = tkn->u.num_int;
+                    value_delta -= prev_sample->value_array[j];
                 }
+                node_mapper_write_zigzag(writer, value_delta);
             }
+            else
+            {
+                int32_t value_delta = sample->value_array[j] / text_format_array[j].divisor;
+
+                if (prev_sample != NULL)
+                {
+                    value_delta -= prev_sample->value_array[j] / text_format_array[j].divisor;
+                }
+                node_mapper_write_char(writer, ',');
+
+                if (text_format_array[j].fraction_size != 0U)
+                {
+                    node_mapper_write_decimal(writer, value_delta, text_format_array[j].fraction_size);
+                }
+                else
+                {
+                    node_mapper_write_integer(writer, value_delta);
+                }
+            }
+        }
+        prev_sample = sample;
+
+        ++index;
+
+        if (index == ARRAY_SIZE(history->sample_array))
+        {
+            index = 0U;
         }
     }
+    return;
+}
+
+void node_mapper_skip_chunk (const char *chunk, size_t chunk_size)
+{
+    UNUSED(chunk);
+    UNUSED(chunk_size);
+
+    return;
+}
+
+void node_mapper_write_char (node_mapper_writer_t * const writer, char symbol)
+{
+    if ((writer->size == writer->capacity) && (writer->sink_callback != NULL))
+    {
+        writer->sink_callback(writer->buffer, writer->size);
+        writer->sink_size += writer->size;
+        writer->size = 0U;
+    }
+
+    if (writer->size < writer->capacity)
+    {
+        writer->buffer[writer->size] = symbol;
+        ++writer->size;
+    }
     else
     {
-        std_error_catch_custom(error, (int)parser_code, DEFAULT_ERROR_TEXT, FILE_NAME, __LINE__);
+        writer->is_overflow = true;
+    }
+    return;
+}
 
-        exit_code = STD_FAILURE;
+void node_mapper_write_text (node_mapper_writer_t * const writer, const char *text)
+{
+    while (*text != '\0')
+    {
+        node_mapper_write_char(writer, *text);
+        ++text;
     }
-    lwjson_free(&lwjson);
+    return;
+}
 
-    return exit_code;
+void node_mapper_write_integer (node_mapper_writer_t * const writer, int32_t value)
+{
+    uint32_t number = (uint32_t)value;
+
+    if (value < 0)
+    {
+        node_mapper_write_char(writer, '-');
+        number = 0UL - number;
+    }
+    node_mapper_write_unsigned(writer, number);
+
+    return;
+}
+
+void node_mapper_write_unsigned (node_mapper_writer_t * const writer, uint32_t value)
+{
+    // Digits by subtraction: AVR has no divider and 32-bit division is a library call
+    static const uint32_t power_array[] = { 1000000000UL, 100000000UL, 10000000UL, 1000000UL, 100000UL, 10000UL, 1000UL, 100UL, 10UL };
+
+    uint32_t number = value;
+    bool is_leading_zero = true;
+
+    for (size_t i = 0U; i < ARRAY_SIZE(power_array); ++i)
+    {
+        char digit = '0';
+
+        while (number >= power_array[i])
+        {
+            number -= power_array[i];
+            ++digit;
+        }
+
+        if ((digit != '0') || (is_leading_zero == false))
+        {
+            node_mapper_write_char(writer, digit);
+            is_leading_zero = false;
+        }
+    }
+    node_mapper_write_char(writer, (char)('0' + (char)number));
+
+    return;
+}
+
+void node_mapper_write_decimal (node_mapper_writer_t * const writer, int32_t value, size_t fraction_size)
+{
+    // Print the fixed-point value aside and put the decimal point in front of the last 'fraction_size' digits
+    char digit_array[12];
+
+    node_mapper_writer_t digit_writer;
+    digit_writer.buffer        = digit_array;
+    digit_writer.capacity      = ARRAY_SIZE(digit_array);
+    digit_writer.size          = 0U;
+    digit_writer.is_overflow   = false;
+    digit_writer.sink_callback = NULL;
+    digit_writer.sink_size     = 0U;
+
+    if (value < 0)
+    {
+        node_mapper_write_char(writer, '-');
+        value = -value;
+    }
+    node_mapper_write_integer(&digit_writer, value);
+
+    // Values below one get leading zeros ("0.05")
+    size_t digit_count = digit_writer.size;
+
+    if (digit_count <= fraction_size)
+    {
+        digit_count = fraction_size + 1U;
+    }
+
+    const size_t zero_count = digit_count - digit_writer.size;
+
+    for (size_t i = 0U; i < digit_count; ++i)
+    {
+        if (i == (digit_count - fraction_size))
+        {
+            node_mapper_write_char(writer, '.');
+        }
+
+        if (i < zero_count)
+        {
+            node_mapper_write_char(writer, '0');
+        }
+        else
+        {
+            node_mapper_write_char(writer, digit_array[i - zero_count]);
+        }
+    }
+    return;
+}
+
+void node_mapper_write_varint (node_mapper_writer_t * const writer, uint32_t value)
+{
+    // 7 bits per byte, the high bit marks a continuation
+    while (value > 0x7FUL)
+    {
+        node_mapper_write_char(writer, (char)((uint8_t)(value) | 0x80U));
+        value >>= 7U;
+    }
+    node_mapper_write_char(writer, (char)(value));
+
+    return;
+}
+
+void node_mapper_write_zigzag (node_mapper_writer_t * const writer, int32_t value)
+{
+    // Small negative values stay short: 0, -1, 1, -2 ... -> 0, 1, 2, 3 ...
+    const uint32_t zigzag = ((uint32_t)(value) << 1U) ^ (uint32_t)(value >> 31U);
+
+    node_mapper_write_varint(writer, zigzag);
+
+    return;
+}
+
+
+uint8_t node_mapper_read_byte (node_mapper_reader_t * const reader)
+{
+    if (reader->position < reader->size)
+    {
+        const uint8_t byte = reader->buffer[reader->position];
+        ++reader->position;
+
+        return byte;
+    }
+    reader->is_underflow = true;
+
+    return 0U;
+}
+
+uint32_t node_mapper_read_varint (node_mapper_reader_t * const reader)
+{
+    uint32_t value = 0UL;
+
+    for (uint8_t shift = 0U; shift < 32U; shift += 7U)
+    {
+        const uint8_t byte = node_mapper_read_byte(reader);
+
+        value |= ((uint32_t)(byte & 0x7FU) << shift);
+
+        if ((byte & 0x80U) == 0U)
+        {
+            break;
+        }
+    }
+    return value;
+}
+
+int32_t node_mapper_read_zigzag (node_mapper_reader_t * const reader)
+{
+    const uint32_t zigzag = node_mapper_read_varint(reader);
+
+    return (int32_t)((zigzag >> 1U) ^ (0UL - (zigzag & 1UL)));
 }
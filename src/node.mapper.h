@@ -7,11 +7,113 @@
 #define NODE_MAPPER_H
 
 #include <stddef.h>
+#include <stdint.h>
+
+#define NODE_MAPPER_BINARY_TYPE 0xB1U // The first byte of a binary message ('{' starts a JSON one)
+
+#define NODE_MAPPER_BINARY_MAX_SIZE 32U // Longer binary messages are skipped by the stream parser
+
+#ifndef NODE_MAPPER_HISTORY_CAPACITY
+#define NODE_MAPPER_HISTORY_CAPACITY 16U // Samples, the oldest one is overwritten when the history is full
+#endif // NODE_MAPPER_HISTORY_CAPACITY
+
+#define NODE_MAPPER_SAMPLE_VALUE_COUNT 2U
+
+// UPDATE_TEMPERATURE carries fixed-point values packed into 'value_0' ('value_1' is not used, so no float math):
+// pressure in 0.1 hPa (high half) and temperature in 0.01 C (low half)
+#define NODE_MAPPER_PACK_TEMPERATURE(pressure_hPa_x10, temperature_C_x100) \
+    (int32_t)(((uint32_t)((uint16_t)(pressure_hPa_x10)) << 16U) | (uint32_t)((uint16_t)((int16_t)(temperature_C_x100))))
+#define NODE_MAPPER_GET_PRESSURE(value_0)       (uint16_t)((uint32_t)(value_0) >> 16U)
+#define NODE_MAPPER_GET_TEMPERATURE(value_0)    (int16_t)((uint16_t)((uint32_t)(value_0) & 0xFFFFUL))
+
+// Acknowledgement of a command which came with a request id, it is not a part of node_command_id_t:
+// 'value_0' carries the acknowledged command (high half) and the request id (low half)
+#define NODE_MAPPER_ACK_CMD_ID 0x7F
+#define NODE_MAPPER_PACK_ACK(cmd_id, request_id) \
+    (int32_t)(((uint32_t)((uint16_t)(cmd_id)) << 16U) | (uint32_t)((uint16_t)(request_id)))
+
+// Sample history of UPDATE_TEMPERATURE readings (outbound only), it is not a part of node_command_id_t:
+// the data is the samples, 'value_0' is not used
+#define NODE_MAPPER_HISTORY_CMD_ID 0x7E
+
+// Energy report, it is not a part of node_command_id_t:
+// 'value_0' carries the estimated average current in 0.01 mA (high half) and the awake time in permille (low half)
+#define NODE_MAPPER_ENERGY_CMD_ID 0x7D
+#define NODE_MAPPER_PACK_ENERGY(current_mA_x100, awake_permille) \
+    (int32_t)(((uint32_t)((uint16_t)(current_mA_x100)) << 16U) | (uint32_t)((uint16_t)(awake_permille)))
+
+// PIR report, it is not a part of node_command_id_t:
+// 'value_0' carries the door (high half) and the veranda (low half) PIR interrupt counts, they wrap around
+#define NODE_MAPPER_MOTION_CMD_ID 0x7B
+#define NODE_MAPPER_PACK_MOTION(door_count, veranda_count) \
+    (int32_t)(((uint32_t)((uint16_t)(door_count)) << 16U) | (uint32_t)((uint16_t)(veranda_count)))
+
+// Hang report after a watchdog reset, it is not a part of node_command_id_t:
+// 'value_0' carries the byte address of the hung code (low half)
+#define NODE_MAPPER_HANG_CMD_ID 0x7C
+#define NODE_MAPPER_PACK_HANG(address) \
+    (int32_t)((uint32_t)((uint16_t)(address)))
+
+#define NODE_MAPPER_NO_REQUEST_ID 0U // The sender does not wait for an acknowledgement
+
+// Group addressing: one bit per node id (ids must be below 32), any subset of nodes in a constant-size header
+#define NODE_MAPPER_NODE_BIT(node_id) ((node_mapper_mask_t)(1UL << (uint32_t)(node_id)))
+
+typedef uint32_t node_mapper_mask_t;
 
 typedef struct node_msg node_msg_t;
 typedef struct std_error std_error_t;
 
-void node_mapper_serialize_message (node_msg_t const * const msg, char *raw_data, size_t * const raw_data_size);
-int node_mapper_deserialize_message (const char *raw_data, node_msg_t * const msg, std_error_t * const error);
+typedef struct node_mapper_sample
+{
+    uint32_t time;                                          // Units are up to the node, the hub knows them
+    int32_t value_array[NODE_MAPPER_SAMPLE_VALUE_COUNT];    // Fixed-point values, as in 'value_0' of the command
+
+} node_mapper_sample_t;
+
+typedef struct node_mapper_history
+{
+    node_mapper_sample_t sample_array[NODE_MAPPER_HISTORY_CAPACITY];
+    size_t first_index;
+    size_t size;
+
+} node_mapper_history_t;
+
+typedef enum node_mapper_format
+{
+    NODE_MAPPER_JSON_FORMAT = 0,    // Human readable, for debugging
+    NODE_MAPPER_BINARY_FORMAT       // Type, length, varint header and zigzag varint values
+
+} node_mapper_format_t;
+
+typedef void (*node_mapper_stream_callback_t) (node_msg_t const * const msg, node_mapper_format_t format, uint16_t request_id);
+typedef void (*node_mapper_sink_callback_t) (const char *chunk, size_t chunk_size);
+
+typedef struct node_mapper_stream_config
+{
+    node_mapper_stream_callback_t msg_callback; // Called for every complete message addressed to 'node_mask'
+    node_mapper_mask_t node_mask;
+
+} node_mapper_stream_config_t;
+
+node_mapper_format_t node_mapper_get_format (const char *raw_data, size_t raw_data_size);
+
+int node_mapper_serialize_message (node_msg_t const * const msg, char *raw_data, size_t raw_data_capacity, size_t * const raw_data_size, std_error_t * const error);
+
+int node_mapper_serialize_binary_message (node_msg_t const * const msg, char *raw_data, size_t raw_data_capacity, size_t * const raw_data_size, std_error_t * const error);
+int node_mapper_deserialize_binary_message (const char *raw_data, size_t raw_data_size, node_msg_t * const msg, std_error_t * const error);
+
+// Messages of both formats in chunks of any size
+int node_mapper_serialize_stream (node_msg_t const * const msg, node_mapper_format_t format, node_mapper_sink_callback_t sink_callback, std_error_t * const error);
+
+// Sample history: the header and the command of 'msg' (NODE_MAPPER_HISTORY_CMD_ID), then every sample as a delta from the previous one
+void node_mapper_clear_history (node_mapper_history_t * const history);
+void node_mapper_push_sample (node_mapper_history_t * const history, node_mapper_sample_t const * const sample);
+void node_mapper_drop_samples (node_mapper_history_t * const history, size_t sample_count); // The oldest ones
+int node_mapper_serialize_history_stream (node_msg_t const * const msg, node_mapper_history_t const * const history, uint32_t time, node_mapper_format_t format, node_mapper_sink_callback_t sink_callback, std_error_t * const error);
+
+void node_mapper_init_stream (node_mapper_stream_config_t const * const init_config);
+void node_mapper_reset_stream ();
+int node_mapper_parse_stream (const char *chunk, size_t chunk_size, std_error_t * const error);
 
 #endif // NODE_MAPPER_H
\ No newline at end of file
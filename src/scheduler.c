@@ -0,0 +1,63 @@
+/************************************************************
+ *   Author : German Mundinger
+ *   Date   : 2023
+ ************************************************************/
+
+#include "scheduler.h"
+
+#include <assert.h>
+
+#include <util/atomic.h>
+
+
+static scheduler_config_t config;
+static volatile scheduler_event_mask_t pending_event_mask;
+
+
+void scheduler_init (scheduler_config_t const * const init_config)
+{
+    assert(init_config != NULL);
+    assert(init_config->task_array_size <= SCHEDULER_TASK_MAX_COUNT);
+
+    config = *init_config;
+
+    pending_event_mask = 0U;
+
+    return;
+}
+
+void scheduler_post_event (scheduler_event_mask_t event_mask)
+{
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        pending_event_mask |= event_mask;
+    }
+    return;
+}
+
+bool scheduler_is_event_pending ()
+{
+    return (pending_event_mask != 0U);
+}
+
+scheduler_event_mask_t scheduler_run ()
+{
+    scheduler_event_mask_t event_mask;
+
+    ATOMIC_BLOCK(ATOMIC_RESTORESTATE)
+    {
+        event_mask = pending_event_mask;
+        pending_event_mask = 0U;
+    }
+
+    for (size_t i = 0U; i < config.task_array_size; ++i)
+    {
+        const scheduler_event_mask_t task_event_mask = event_mask & config.task_array[i].event_mask;
+
+        if (task_event_mask != 0U)
+        {
+            config.task_array[i].task_callback(task_event_mask);
+        }
+    }
+    return event_mask;
+}
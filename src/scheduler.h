@@ -0,0 +1,44 @@
+/************************************************************
+ *   Author : German Mundinger
+ *   Date   : 2023
+ ************************************************************/
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define SCHEDULER_TASK_MAX_COUNT 8U
+
+typedef uint8_t scheduler_event_mask_t; // One bit per event
+
+typedef void (*scheduler_task_callback_t) (scheduler_event_mask_t event_mask);
+
+typedef struct scheduler_task
+{
+    scheduler_task_callback_t task_callback;    // Gets the pending events it is subscribed to
+    scheduler_event_mask_t event_mask;          // Subscribed events
+
+} scheduler_task_t;
+
+typedef struct scheduler_config
+{
+    scheduler_task_t task_array[SCHEDULER_TASK_MAX_COUNT]; // Tasks run in this order
+    size_t task_array_size;
+
+} scheduler_config_t;
+
+void scheduler_init (scheduler_config_t const * const init_config);
+
+// May be called from interrupts
+void scheduler_post_event (scheduler_event_mask_t event_mask);
+
+// Interrupts must be disabled, so no event is lost between the check and sleeping
+bool scheduler_is_event_pending ();
+
+// Takes all pending events and runs the tasks subscribed to them, events posted meanwhile wait for the next run
+scheduler_event_mask_t scheduler_run ();
+
+#endif // SCHEDULER_H
\ No newline at end of file
@@ -14,6 +14,17 @@
 #include "logger.h"
 
 #define W5500_SOCKET_NUMBER 0U
+#define W5500_KEEPALIVE_TIME 2U     // * 5 sec
+
+#define SERVER_MAX_BACKOFF_COUNT 32U // Connection attempts (~ wake-ups) to skip a dead server
+
+#define ETHERNET_ADDRESS_SIZE       6U
+#define ETHERNET_HEADER_SIZE        14U     // Destination MAC + Source MAC + EtherType
+#define ETHERNET_MIN_FRAME_SIZE     60U     // Without FCS
+#define MACRAW_PACKET_INFO_SIZE     2U      // W5500 puts the frame size in front of each received frame
+#define MACRAW_PAYLOAD_LENGTH_SIZE  2U      // Message size follows EtherType (frames can be padded)
+
+#define RX_CHUNK_SIZE 16U // Received data is passed on in chunks straight from the W5500 RX buffer
 
 #define FILE_NAME           "tcp_client.c"
 #define DEFAULT_ERROR_TEXT  "TCP error"
@@ -33,9 +44,28 @@
 #endif // NDEBUG
 
 
+typedef struct tcp_client_server_health
+{
+    uint8_t fail_count;     // Consecutive failures
+    uint8_t backoff_count;  // Connection attempts to skip before the server is tried again
+
+} tcp_client_server_health_t;
+
+
 static tcp_client_config_t config;
 static bool is_message_received;
 static bool is_connected;
+static bool is_connecting;          // The connection is being established in the background
+static bool is_sending;
+static int8_t sending_exit_code;
+
+static tcp_client_server_health_t server_health_array[TCP_CLIENT_SERVER_MAX_COUNT];
+static size_t server_index;
+
+static uint16_t tx_start_pointer;   // Sn_TX_WR at the beginning of the message
+static uint16_t tx_free_size;
+static uint16_t tx_size;            // Payload written so far
+static bool is_tx_overflow;
 
 
 static void tcp_client_spi_select ();
@@ -45,6 +75,17 @@ static void tcp_client_spi_write_byte (uint8_t byte);
 
 static int tcp_client_setup_w5500 (std_error_t * const error);
 
+static size_t tcp_client_select_server ();
+static void tcp_client_mark_server_failed ();
+
+static int tcp_client_connect_macraw (std_error_t * const error);
+static void tcp_client_receive_tcp_stream (tcp_client_receive_callback_t receive_callback);
+static void tcp_client_receive_macraw_stream (tcp_client_receive_callback_t receive_callback);
+static void tcp_client_read_rx_buffer (uint16_t data_size, tcp_client_receive_callback_t receive_callback);
+static void tcp_client_begin_macraw_message ();
+static void tcp_client_end_macraw_message ();
+static void tcp_client_update_sending ();
+
 int tcp_client_init (tcp_client_config_t const * const init_config, std_error_t * const error)
 {
     assert(init_config                          != NULL);
@@ -52,21 +93,36 @@ int tcp_client_init (tcp_client_config_t const * const init_config, std_error_t
     assert(init_config->spi_unselect_callback   != NULL);
     assert(init_config->spi_read_callback       != NULL);
     assert(init_config->spi_write_callback      != NULL);
+    assert((init_config->transport == TCP_CLIENT_TRANSPORT_MACRAW) || (init_config->server_array_size != 0U));
+    assert(init_config->server_array_size <= TCP_CLIENT_SERVER_MAX_COUNT);
 
     memcpy((void*)(&config), (const void*)(init_config), sizeof(tcp_client_config_t));
 
     is_message_received = false;
     is_connected        = false;
+    is_connecting       = false;
+    is_sending          = false;
+    sending_exit_code   = SOCK_OK;
+
+    for (size_t i = 0U; i < ARRAY_SIZE(server_health_array); ++i)
+    {
+        server_health_array[i].fail_count       = 0U;
+        server_health_array[i].backoff_count    = 0U;
+    }
+    server_index = 0U;
 
     return tcp_client_setup_w5500(error);
 }
 
 void tcp_client_check_interrupts ()
 {
+    // 'SIK_SENT' is cleared there, when the result is taken
+    tcp_client_update_sending();
+
     uint8_t interrupt_kind;
     ctlsocket(W5500_SOCKET_NUMBER, CS_GET_INTERRUPT, (void*)(&interrupt_kind));
 
-    uint8_t clear_interrupt = (uint8_t)(SIK_RECEIVED | SIK_DISCONNECTED);
+    uint8_t clear_interrupt = (uint8_t)(SIK_CONNECTED | SIK_RECEIVED | SIK_DISCONNECTED | SIK_TIMEOUT);
     ctlsocket(W5500_SOCKET_NUMBER, CS_CLR_INTERRUPT, (void*)(&clear_interrupt));
 
     if ((interrupt_kind & (uint8_t)(SIK_RECEIVED)) != 0U)
@@ -76,11 +132,24 @@ void tcp_client_check_interrupts ()
         is_message_received = true;
     }
 
-    if ((interrupt_kind & (uint8_t)(SIK_DISCONNECTED)) != 0U)
+    if ((interrupt_kind & (uint8_t)(SIK_DISCONNECTED | SIK_TIMEOUT)) != 0U)
     {
         LOG("TCP-SIK_DISCONNECTED\r\n");
 
-        is_connected = false;
+        // Server has gone or keepalive has been lost -> switch to the next one
+        if (config.transport == TCP_CLIENT_TRANSPORT_TCP)
+        {
+            tcp_client_mark_server_failed();
+        }
+
+        is_connected    = false;
+        is_connecting   = false;
+
+        if (is_sending == true)
+        {
+            is_sending          = false;
+            sending_exit_code   = SOCKERR_TIMEOUT;
+        }
 
         // Disable interrupts
         uint8_t clear_interrupt_mask = 0U;
@@ -89,18 +158,17 @@ void tcp_client_check_interrupts ()
     return;
 }
 
-void tcp_client_receive_message (tcp_msg_t * const tcp_msg)
+void tcp_client_receive_stream (tcp_client_receive_callback_t receive_callback)
 {
-    assert(tcp_msg != NULL);
+    assert(receive_callback != NULL);
 
-    tcp_msg->size = 0U;
-
-    if (is_message_received == true)
+    if ((is_message_received == true) && (config.transport == TCP_CLIENT_TRANSPORT_MACRAW))
     {
-        tcp_msg->size = (size_t)recv(W5500_SOCKET_NUMBER, (uint8_t*)tcp_msg->buffer, ARRAY_SIZE(tcp_msg->buffer));
-        tcp_msg->buffer[tcp_msg->size] = '\0';
-
-        is_message_received = false;
+        tcp_client_receive_macraw_stream(receive_callback);
+    }
+    else if (is_message_received == true)
+    {
+        tcp_client_receive_tcp_stream(receive_callback);
     }
     return;
 }
@@ -118,8 +186,63 @@ int tcp_client_connect (std_error_t * const error)
         return STD_FAILURE;
     }
 
+    if (config.transport == TCP_CLIENT_TRANSPORT_MACRAW)
+    {
+        return tcp_client_connect_macraw(error);
+    }
+
+    // Fall back to a server with higher priority as soon as it is worth retrying
+    const size_t preferred_server_index = tcp_client_select_server();
+
+    if ((is_connected == true) && (preferred_server_index < server_index) && (is_sending == false))
+    {
+        TCP_DEBUG("try to switch a server");
+
+        if (disconnect(W5500_SOCKET_NUMBER) != SOCK_OK)
+        {
+            close(W5500_SOCKET_NUMBER);
+        }
+        is_connected = false;
+    }
+
+    if (is_connecting == true)
+    {
+        uint8_t socket_status;
+        getsockopt(W5500_SOCKET_NUMBER, SO_STATUS, (void*)(&socket_status));
+
+        if (socket_status == SOCK_ESTABLISHED)
+        {
+            is_connecting = false;
+
+            server_health_array[server_index].fail_count    = 0U;
+            server_health_array[server_index].backoff_count = 0U;
+
+            uint8_t keepalive_time = W5500_KEEPALIVE_TIME;
+            setsockopt(W5500_SOCKET_NUMBER, SO_KEEPALIVEAUTO, (void*)(&keepalive_time));
+
+            uint8_t socket_interrupt_mask = (uint8_t)(SIK_DISCONNECTED | SIK_TIMEOUT | SIK_RECEIVED | SIK_SENT);
+            ctlsocket(W5500_SOCKET_NUMBER, CS_SET_INTMASK, (void*)(&socket_interrupt_mask));
+
+            is_connected = true;
+        }
+        else if (socket_status == SOCK_CLOSED)
+        {
+            // The W5500 has given up (its retransmission timeout)
+            is_connecting = false;
+
+            tcp_client_mark_server_failed();
+
+            std_error_catch_custom(error, (int)SOCKERR_TIMEOUT, DEFAULT_ERROR_TEXT, FILE_NAME, __LINE__);
+
+            return STD_FAILURE;
+        }
+        return STD_SUCCESS;
+    }
+
     if (is_connected == false)
     {
+        server_index = preferred_server_index;
+
         TCP_DEBUG("try to disconnect");
 
         uint8_t socket_status;
@@ -137,7 +260,7 @@ int tcp_client_connect (std_error_t * const error)
 
         TCP_DEBUG("try to create a socket");
 
-        int8_t exit_code = socket(W5500_SOCKET_NUMBER, Sn_MR_TCP, 0U, 0U);
+        int8_t exit_code = socket(W5500_SOCKET_NUMBER, Sn_MR_TCP, 0U, SF_IO_NONBLOCK);
 
         if (exit_code != W5500_SOCKET_NUMBER)
         {
@@ -148,30 +271,36 @@ int tcp_client_connect (std_error_t * const error)
 
         TCP_DEBUG("try to connect");
 
-        exit_code = connect(W5500_SOCKET_NUMBER, config.server_ip, config.server_port);
+        tcp_client_server_t * const server = &config.server_array[server_index];
+
+        // Non-blocking socket: SYN is sent, the result comes with 'SIK_CONNECTED' or 'SIK_TIMEOUT'
+        exit_code = connect(W5500_SOCKET_NUMBER, server->ip, server->port);
 
-        if (exit_code != SOCK_OK)
+        if ((exit_code != SOCK_BUSY) && (exit_code != SOCK_OK))
         {
+            tcp_client_mark_server_failed();
+
             std_error_catch_custom(error, (int)exit_code, DEFAULT_ERROR_TEXT, FILE_NAME, __LINE__);
 
             return STD_FAILURE;
         }
-        else
-        {
-            uint8_t socket_interrupt_mask = (uint8_t)(SIK_DISCONNECTED | SIK_RECEIVED);
-            ctlsocket(W5500_SOCKET_NUMBER, CS_SET_INTMASK, (void*)(&socket_interrupt_mask));
 
-            is_connected = true;
-        }
+        uint8_t socket_interrupt_mask = (uint8_t)(SIK_CONNECTED | SIK_DISCONNECTED | SIK_TIMEOUT);
+        ctlsocket(W5500_SOCKET_NUMBER, CS_SET_INTMASK, (void*)(&socket_interrupt_mask));
+
+        is_connecting = true;
     }
 
     return STD_SUCCESS;
 }
 
-int tcp_client_send_message (tcp_msg_t const * const tcp_msg, std_error_t * const error)
+bool tcp_client_is_connected ()
 {
-    assert(tcp_msg != NULL);
+    return is_connected;
+}
 
+int tcp_client_begin_message (std_error_t * const error)
+{
     if (is_connected == false)
     {
         std_error_catch_custom(error, (-1), DEFAULT_ERROR_TEXT, FILE_NAME, __LINE__);
@@ -189,18 +318,346 @@ int tcp_client_send_message (tcp_msg_t const * const tcp_msg, std_error_t * cons
         return STD_FAILURE;
     }
 
-    const int32_t exit_code = send(W5500_SOCKET_NUMBER, (uint8_t*)tcp_msg->buffer, (uint16_t)tcp_msg->size);
+    // The W5500 sends one message at a time
+    if (tcp_client_is_sending() == true)
+    {
+        std_error_catch_custom(error, (int)SOCK_BUSY, BUSY_ERROR_TEXT, FILE_NAME, __LINE__);
+
+        return STD_FAILURE;
+    }
+
+    tx_start_pointer    = getSn_TX_WR(W5500_SOCKET_NUMBER);
+    tx_free_size        = getSn_TX_FSR(W5500_SOCKET_NUMBER);
+    tx_size             = 0U;
+    is_tx_overflow      = false;
+
+    if (config.transport == TCP_CLIENT_TRANSPORT_MACRAW)
+    {
+        if (tx_free_size < (uint16_t)(ETHERNET_MIN_FRAME_SIZE))
+        {
+            std_error_catch_custom(error, (int)SOCK_BUSY, BUSY_ERROR_TEXT, FILE_NAME, __LINE__);
+
+            return STD_FAILURE;
+        }
+        tcp_client_begin_macraw_message();
+    }
+
+    return STD_SUCCESS;
+}
+
+void tcp_client_append_message (const char *chunk, size_t chunk_size)
+{
+    assert(chunk != NULL);
+
+    if (is_tx_overflow == true)
+    {
+        return;
+    }
+
+    uint16_t reserved_size = 0U;
+
+    if (config.transport == TCP_CLIENT_TRANSPORT_MACRAW)
+    {
+        reserved_size = (uint16_t)(ETHERNET_HEADER_SIZE + MACRAW_PAYLOAD_LENGTH_SIZE);
+    }
+
+    if (((size_t)tx_size + chunk_size) > (size_t)(tx_free_size - reserved_size))
+    {
+        is_tx_overflow = true;
+
+        return;
+    }
+
+    wiz_send_data(W5500_SOCKET_NUMBER, (uint8_t*)chunk, (uint16_t)chunk_size);
+    tx_size += (uint16_t)chunk_size;
+
+    return;
+}
+
+size_t tcp_client_get_message_size ()
+{
+    return (size_t)tx_size;
+}
 
-    if (exit_code < SOCK_OK)
+int tcp_client_end_message (std_error_t * const error)
+{
+    if ((is_tx_overflow == true) || (tx_size == 0U))
     {
-        std_error_catch_custom(error, (int)exit_code, SENDING_ERROR_TEXT, FILE_NAME, __LINE__);
+        tcp_client_abort_message();
+
+        std_error_catch_custom(error, (int)SOCK_BUSY, BUSY_ERROR_TEXT, FILE_NAME, __LINE__);
 
         return STD_FAILURE;
     }
 
+    if (config.transport == TCP_CLIENT_TRANSPORT_MACRAW)
+    {
+        tcp_client_end_macraw_message();
+    }
+
+    setSn_CR(W5500_SOCKET_NUMBER, Sn_CR_SEND);
+    while (getSn_CR(W5500_SOCKET_NUMBER) != 0U);
+
+    is_sending          = true;
+    sending_exit_code   = SOCK_OK;
+
     return STD_SUCCESS;
 }
 
+void tcp_client_abort_message ()
+{
+    // Nothing has been sent yet, so the written data is simply dropped
+    setSn_TX_WR(W5500_SOCKET_NUMBER, tx_start_pointer);
+
+    return;
+}
+
+bool tcp_client_is_sending ()
+{
+    tcp_client_update_sending();
+
+    return is_sending;
+}
+
+int tcp_client_get_sending_result (std_error_t * const error)
+{
+    if (sending_exit_code != SOCK_OK)
+    {
+        std_error_catch_custom(error, (int)sending_exit_code, SENDING_ERROR_TEXT, FILE_NAME, __LINE__);
+
+        return STD_FAILURE;
+    }
+    return STD_SUCCESS;
+}
+
+
+size_t tcp_client_select_server ()
+{
+    // The first healthy server by priority, dead ones are skipped until their backoff expires
+    size_t selected_index = server_index;
+
+    for (size_t i = 0U; i < config.server_array_size; ++i)
+    {
+        tcp_client_server_health_t * const health = &server_health_array[i];
+
+        if (health->backoff_count == 0U)
+        {
+            selected_index = i;
+
+            break;
+        }
+        --health->backoff_count;
+    }
+    return selected_index;
+}
+
+void tcp_client_mark_server_failed ()
+{
+    tcp_client_server_health_t * const health = &server_health_array[server_index];
+
+    if (health->fail_count < 8U)
+    {
+        ++health->fail_count;
+    }
+
+    uint16_t backoff_count = (uint16_t)(1U << health->fail_count);
+
+    if (backoff_count > SERVER_MAX_BACKOFF_COUNT)
+    {
+        backoff_count = SERVER_MAX_BACKOFF_COUNT;
+    }
+    health->backoff_count = (uint8_t)(backoff_count);
+
+    LOG("TCP server %u failed\r\n", (unsigned)(server_index));
+
+    // Next connection attempt goes to the next server in the list
+    server_index = (server_index + 1U) % config.server_array_size;
+
+    return;
+}
+
+int tcp_client_connect_macraw (std_error_t * const error)
+{
+    if (is_connected == false)
+    {
+        TCP_DEBUG("try to open a raw socket");
+
+        // MACRAW is available on socket 0 only, receive broadcast and own frames only
+        const int8_t exit_code = socket(W5500_SOCKET_NUMBER, Sn_MR_MACRAW, 0U, SF_ETHER_OWN);
+
+        if (exit_code != W5500_SOCKET_NUMBER)
+        {
+            std_error_catch_custom(error, (int)exit_code, DEFAULT_ERROR_TEXT, FILE_NAME, __LINE__);
+
+            return STD_FAILURE;
+        }
+
+        uint8_t socket_interrupt_mask = (uint8_t)(SIK_RECEIVED | SIK_SENT);
+        ctlsocket(W5500_SOCKET_NUMBER, CS_SET_INTMASK, (void*)(&socket_interrupt_mask));
+
+        is_connected = true;
+    }
+
+    return STD_SUCCESS;
+}
+
+void tcp_client_receive_tcp_stream (tcp_client_receive_callback_t receive_callback)
+{
+    const uint16_t data_size = getSn_RX_RSR(W5500_SOCKET_NUMBER);
+
+    tcp_client_read_rx_buffer(data_size, receive_callback);
+
+    setSn_CR(W5500_SOCKET_NUMBER, Sn_CR_RECV);
+    while (getSn_CR(W5500_SOCKET_NUMBER) != 0U);
+
+    is_message_received = (getSn_RX_RSR(W5500_SOCKET_NUMBER) != 0U);
+
+    return;
+}
+
+void tcp_client_receive_macraw_stream (tcp_client_receive_callback_t receive_callback)
+{
+    // Every frame in the RX buffer, foreign frames are dropped
+    uint16_t data_size;
+
+    while ((data_size = getSn_RX_RSR(W5500_SOCKET_NUMBER)) != 0U)
+    {
+        uint8_t header[MACRAW_PACKET_INFO_SIZE + ETHERNET_HEADER_SIZE + MACRAW_PAYLOAD_LENGTH_SIZE];
+
+        wiz_recv_data(W5500_SOCKET_NUMBER, header, MACRAW_PACKET_INFO_SIZE);
+
+        uint16_t frame_size = (uint16_t)(((uint16_t)(header[0]) << 8U) | (uint16_t)(header[1]));
+
+        // The packet info counts itself, a broken one (e.g. a corrupted SPI read) loses the frame boundaries
+        if ((frame_size < (uint16_t)(MACRAW_PACKET_INFO_SIZE)) || (frame_size > data_size))
+        {
+            LOG("TCP-MACRAW_BROKEN_FRAME\r\n");
+
+            // The socket is reopened with an empty RX buffer on the next connect
+            close(W5500_SOCKET_NUMBER);
+            is_connected = false;
+
+            break;
+        }
+        frame_size -= (uint16_t)(MACRAW_PACKET_INFO_SIZE);
+
+        if (frame_size >= (uint16_t)(ETHERNET_HEADER_SIZE + MACRAW_PAYLOAD_LENGTH_SIZE))
+        {
+            uint8_t *frame_header = header + MACRAW_PACKET_INFO_SIZE;
+
+            wiz_recv_data(W5500_SOCKET_NUMBER, frame_header, (uint16_t)(ETHERNET_HEADER_SIZE + MACRAW_PAYLOAD_LENGTH_SIZE));
+            frame_size -= (uint16_t)(ETHERNET_HEADER_SIZE + MACRAW_PAYLOAD_LENGTH_SIZE);
+
+            const uint16_t ether_type = (uint16_t)(((uint16_t)(frame_header[12]) << 8U) | (uint16_t)(frame_header[13]));
+            const uint16_t payload_size = (uint16_t)(((uint16_t)(frame_header[14]) << 8U) | (uint16_t)(frame_header[15]));
+
+            if ((ether_type == config.ether_type) && (payload_size <= frame_size))
+            {
+                tcp_client_read_rx_buffer(payload_size, receive_callback);
+                frame_size -= payload_size;
+            }
+        }
+
+        // Drop the rest of the frame (padding, foreign data)
+        wiz_recv_ignore(W5500_SOCKET_NUMBER, frame_size);
+
+        setSn_CR(W5500_SOCKET_NUMBER, Sn_CR_RECV);
+        while (getSn_CR(W5500_SOCKET_NUMBER) != 0U);
+    }
+
+    is_message_received = false;
+
+    return;
+}
+
+void tcp_client_read_rx_buffer (uint16_t data_size, tcp_client_receive_callback_t receive_callback)
+{
+    while (data_size != 0U)
+    {
+        char chunk[RX_CHUNK_SIZE];
+
+        uint16_t chunk_size = (uint16_t)(ARRAY_SIZE(chunk));
+
+        if (chunk_size > data_size)
+        {
+            chunk_size = data_size;
+        }
+
+        wiz_recv_data(W5500_SOCKET_NUMBER, (uint8_t*)chunk, chunk_size);
+        data_size -= chunk_size;
+
+        receive_callback(chunk, (size_t)chunk_size);
+    }
+    return;
+}
+
+void tcp_client_begin_macraw_message ()
+{
+    // Broadcast to every node on the segment, the payload length is filled in at the end
+    uint8_t header[ETHERNET_HEADER_SIZE + MACRAW_PAYLOAD_LENGTH_SIZE];
+    memset((void*)(header), 0xFF, ETHERNET_ADDRESS_SIZE);
+    memcpy((void*)(header + ETHERNET_ADDRESS_SIZE), (const void*)(config.mac_address), ETHERNET_ADDRESS_SIZE);
+    header[12] = (uint8_t)(config.ether_type >> 8U);
+    header[13] = (uint8_t)(config.ether_type);
+    header[14] = 0U;
+    header[15] = 0U;
+
+    wiz_send_data(W5500_SOCKET_NUMBER, header, (uint16_t)(sizeof(header)));
+
+    return;
+}
+
+void tcp_client_end_macraw_message ()
+{
+    const uint16_t frame_size = (uint16_t)(ETHERNET_HEADER_SIZE + MACRAW_PAYLOAD_LENGTH_SIZE) + tx_size;
+
+    if (frame_size < (uint16_t)(ETHERNET_MIN_FRAME_SIZE))
+    {
+        uint8_t padding[ETHERNET_MIN_FRAME_SIZE - ETHERNET_HEADER_SIZE] = { 0U };
+
+        wiz_send_data(W5500_SOCKET_NUMBER, padding, (uint16_t)(ETHERNET_MIN_FRAME_SIZE) - frame_size);
+    }
+
+    // Patch the payload length and move the write pointer back to the end of the frame
+    const uint16_t end_pointer = getSn_TX_WR(W5500_SOCKET_NUMBER);
+
+    uint8_t payload_length[MACRAW_PAYLOAD_LENGTH_SIZE];
+    payload_length[0] = (uint8_t)(tx_size >> 8U);
+    payload_length[1] = (uint8_t)(tx_size);
+
+    setSn_TX_WR(W5500_SOCKET_NUMBER, tx_start_pointer + (uint16_t)(ETHERNET_HEADER_SIZE));
+    wiz_send_data(W5500_SOCKET_NUMBER, payload_length, (uint16_t)(sizeof(payload_length)));
+    setSn_TX_WR(W5500_SOCKET_NUMBER, end_pointer);
+
+    return;
+}
+
+void tcp_client_update_sending ()
+{
+    if (is_sending == true)
+    {
+        if ((getSn_IR(W5500_SOCKET_NUMBER) & Sn_IR_SENDOK) != 0U)
+        {
+            setSn_IR(W5500_SOCKET_NUMBER, Sn_IR_SENDOK);
+
+            is_sending          = false;
+            sending_exit_code   = SOCK_OK;
+        }
+        else if (getSn_SR(W5500_SOCKET_NUMBER) == SOCK_CLOSED)
+        {
+            is_connected        = false;
+            is_sending          = false;
+            sending_exit_code   = SOCKERR_SOCKCLOSED;
+        }
+        else if ((getSn_IR(W5500_SOCKET_NUMBER) & Sn_IR_TIMEOUT) != 0U)
+        {
+            is_sending          = false;
+            sending_exit_code   = SOCKERR_TIMEOUT;
+        }
+    }
+    return;
+}
+
 
 int tcp_client_setup_w5500 (std_error_t * const error)
 {
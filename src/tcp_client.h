@@ -12,16 +12,26 @@
 
 typedef struct std_error std_error_t;
 
-typedef struct tcp_msg
-{
-    char buffer[128];
-    size_t size;
-
-} tcp_msg_t;
+#define TCP_CLIENT_SERVER_MAX_COUNT 3U
 
 typedef void (*tcp_client_spi_select_callback_t) ();
 typedef void (*tcp_client_spi_rx_callback_t) (uint8_t * const byte);
 typedef void (*tcp_client_spi_tx_callback_t) (uint8_t byte);
+typedef void (*tcp_client_receive_callback_t) (const char *chunk, size_t chunk_size);
+
+typedef enum tcp_client_transport
+{
+    TCP_CLIENT_TRANSPORT_TCP = 0,   // Messages are exchanged with the server over a TCP connection
+    TCP_CLIENT_TRANSPORT_MACRAW     // Messages are broadcasted as raw Ethernet frames (no TCP, no ARP)
+
+} tcp_client_transport_t;
+
+typedef struct tcp_client_server
+{
+    uint8_t ip[4];
+    uint16_t port;
+
+} tcp_client_server_t;
 
 typedef struct tcp_client_config
 {
@@ -34,16 +44,32 @@ typedef struct tcp_client_config
     uint8_t ip_address[4];
     uint8_t netmask[4];
 
-    uint8_t server_ip[4];
-    uint16_t server_port;
+    tcp_client_transport_t transport;
+
+    // TCP transport (servers are ordered by priority, the first one is primary)
+    tcp_client_server_t server_array[TCP_CLIENT_SERVER_MAX_COUNT];
+    size_t server_array_size;
+
+    // MACRAW transport
+    uint16_t ether_type;
 
 } tcp_client_config_t;
 
 int tcp_client_init (tcp_client_config_t const * const init_config, std_error_t * const error);
 
 void tcp_client_check_interrupts ();
-void tcp_client_receive_message (tcp_msg_t * const tcp_msg);
+void tcp_client_receive_stream (tcp_client_receive_callback_t receive_callback);
 int tcp_client_connect (std_error_t * const error);
-int tcp_client_send_message (tcp_msg_t const * const tcp_msg, std_error_t * const error);
+bool tcp_client_is_connected ();
+
+// A message is written straight into the W5500 TX buffer in chunks of any size and sent at once.
+// It is sent in the background, the result is taken as soon as 'tcp_client_is_sending' is false
+int tcp_client_begin_message (std_error_t * const error);
+void tcp_client_append_message (const char *chunk, size_t chunk_size);
+size_t tcp_client_get_message_size ();
+int tcp_client_end_message (std_error_t * const error);
+void tcp_client_abort_message ();
+bool tcp_client_is_sending ();
+int tcp_client_get_sending_result (std_error_t * const error);
 
 #endif // TCP_CLIENT_H
\ No newline at end of file
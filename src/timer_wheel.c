@@ -0,0 +1,227 @@
+/************************************************************
+ *   Author : German Mundinger
+ *   Date   : 2023
+ ************************************************************/
+
+#include "timer_wheel.h"
+
+#include <stddef.h>
+#include <assert.h>
+
+
+#define SLOT_COUNT      8U          // Power of 2
+#define SLOT_SHIFT      7U          // 128 ms per slot, the wheel turns in ~1 sec
+#define EXPIRED_SLOT    SLOT_COUNT  // Timers, which are about to be called back
+
+#define MAX_DELAY_MS    0x7FFFFFFFUL
+
+#define ARRAY_SIZE(array) (sizeof(array) / sizeof((array)[0]))
+
+
+static timer_wheel_config_t config;
+static timer_wheel_timer_t *slot_array[SLOT_COUNT + 1U];
+static uint32_t wheel_time_ms;  // Time of the last processing
+
+
+static uint8_t timer_wheel_get_slot (uint32_t time_ms);
+static bool timer_wheel_is_expired (uint32_t deadline_ms, uint32_t time_ms);
+static void timer_wheel_link (timer_wheel_timer_t * const timer, uint8_t slot);
+static void timer_wheel_unlink (timer_wheel_timer_t * const timer);
+
+void timer_wheel_init (timer_wheel_config_t const * const init_config)
+{
+    assert(init_config != NULL);
+    assert(init_config->time_callback != NULL);
+
+    config = *init_config;
+
+    for (size_t i = 0U; i < ARRAY_SIZE(slot_array); ++i)
+    {
+        slot_array[i] = NULL;
+    }
+    wheel_time_ms = config.time_callback();
+
+    return;
+}
+
+void timer_wheel_init_timer (timer_wheel_timer_t * const timer, timer_wheel_callback_t callback)
+{
+    assert(timer    != NULL);
+    assert(callback != NULL);
+
+    timer->callback     = callback;
+    timer->deadline_ms  = 0UL;
+    timer->period_ms    = 0UL;
+    timer->next         = NULL;
+    timer->prev         = NULL;
+    timer->slot         = 0U;
+    timer->is_running   = false;
+
+    return;
+}
+
+void timer_wheel_start (timer_wheel_timer_t * const timer, uint32_t delay_ms, uint32_t period_ms)
+{
+    assert(timer != NULL);
+    assert(delay_ms     <= MAX_DELAY_MS);
+    assert(period_ms    <= MAX_DELAY_MS);
+
+    if (timer->is_running == true)
+    {
+        timer_wheel_unlink(timer);
+    }
+
+    // The wheel may be behind the current time (a task started it long after the processing)
+    timer->deadline_ms  = config.time_callback() + delay_ms;
+    timer->period_ms    = period_ms;
+    timer->is_running   = true;
+
+    timer_wheel_link(timer, timer_wheel_get_slot(timer->deadline_ms));
+
+    return;
+}
+
+void timer_wheel_stop (timer_wheel_timer_t * const timer)
+{
+    assert(timer != NULL);
+
+    if (timer->is_running == true)
+    {
+        timer_wheel_unlink(timer);
+
+        timer->is_running = false;
+    }
+    return;
+}
+
+bool timer_wheel_is_running (timer_wheel_timer_t const * const timer)
+{
+    assert(timer != NULL);
+
+    return timer->is_running;
+}
+
+void timer_wheel_process (uint32_t time_ms)
+{
+    // Only the slots the time has passed through are looked at, all of them after a long pause
+    const uint32_t turn_count = (time_ms >> SLOT_SHIFT) - (wheel_time_ms >> SLOT_SHIFT);
+
+    uint8_t slot = timer_wheel_get_slot(wheel_time_ms);
+
+    for (uint32_t i = 0UL; (i <= turn_count) && (i < SLOT_COUNT); ++i)
+    {
+        timer_wheel_timer_t *timer = slot_array[slot];
+
+        while (timer != NULL)
+        {
+            timer_wheel_timer_t * const next_timer = timer->next;
+
+            if (timer_wheel_is_expired(timer->deadline_ms, time_ms) == true)
+            {
+                timer_wheel_unlink(timer);
+                timer_wheel_link(timer, EXPIRED_SLOT);
+            }
+            timer = next_timer;
+        }
+        slot = (uint8_t)((slot + 1U) & (SLOT_COUNT - 1U));
+    }
+    wheel_time_ms = time_ms;
+
+    // Timers are rearmed before the callbacks, so a callback may start or stop any timer
+    while (slot_array[EXPIRED_SLOT] != NULL)
+    {
+        timer_wheel_timer_t * const timer = slot_array[EXPIRED_SLOT];
+
+        timer_wheel_unlink(timer);
+
+        if (timer->period_ms != 0UL)
+        {
+            timer->deadline_ms += timer->period_ms;
+
+            // A late timer does not catch up with the missed periods
+            if (timer_wheel_is_expired(timer->deadline_ms, time_ms) == true)
+            {
+                timer->deadline_ms = time_ms + timer->period_ms;
+            }
+            timer_wheel_link(timer, timer_wheel_get_slot(timer->deadline_ms));
+        }
+        else
+        {
+            timer->is_running = false;
+        }
+        timer->callback();
+    }
+    return;
+}
+
+bool timer_wheel_get_next_deadline (uint32_t * const deadline_ms)
+{
+    assert(deadline_ms != NULL);
+
+    bool is_found = false;
+    uint32_t min_delay_ms = MAX_DELAY_MS;
+
+    for (size_t i = 0U; i < SLOT_COUNT; ++i)
+    {
+        for (timer_wheel_timer_t const *timer = slot_array[i]; timer != NULL; timer = timer->next)
+        {
+            const uint32_t delay_ms = timer->deadline_ms - wheel_time_ms;
+
+            if ((is_found == false) || (delay_ms < min_delay_ms))
+            {
+                min_delay_ms = delay_ms;
+                is_found = true;
+            }
+        }
+    }
+    *deadline_ms = wheel_time_ms + min_delay_ms;
+
+    return is_found;
+}
+
+
+uint8_t timer_wheel_get_slot (uint32_t time_ms)
+{
+    return (uint8_t)((time_ms >> SLOT_SHIFT) & (SLOT_COUNT - 1U));
+}
+
+bool timer_wheel_is_expired (uint32_t deadline_ms, uint32_t time_ms)
+{
+    return (int32_t)(time_ms - deadline_ms) >= 0L;
+}
+
+void timer_wheel_link (timer_wheel_timer_t * const timer, uint8_t slot)
+{
+    timer->slot = slot;
+    timer->prev = NULL;
+    timer->next = slot_array[slot];
+
+    if (timer->next != NULL)
+    {
+        timer->next->prev = timer;
+    }
+    slot_array[slot] = timer;
+
+    return;
+}
+
+void timer_wheel_unlink (timer_wheel_timer_t * const timer)
+{
+    if (timer->prev != NULL)
+    {
+        timer->prev->next = timer->next;
+    }
+    else
+    {
+        slot_array[timer->slot] = timer->next;
+    }
+
+    if (timer->next != NULL)
+    {
+        timer->next->prev = timer->prev;
+    }
+    timer->next = NULL;
+    timer->prev = NULL;
+
+    return;
+}
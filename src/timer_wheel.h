@@ -0,0 +1,47 @@
+/************************************************************
+ *   Author : German Mundinger
+ *   Date   : 2023
+ ************************************************************/
+
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef void (*timer_wheel_callback_t) ();
+typedef uint32_t (*timer_wheel_time_callback_t) ();
+
+typedef struct timer_wheel_timer
+{
+    timer_wheel_callback_t callback; // Called from 'timer_wheel_process', not from an interrupt
+
+    uint32_t deadline_ms;
+    uint32_t period_ms; // 0 - one-shot timer
+
+    struct timer_wheel_timer *next;
+    struct timer_wheel_timer *prev;
+    uint8_t slot;
+    bool is_running;
+
+} timer_wheel_timer_t;
+
+typedef struct timer_wheel_config
+{
+    timer_wheel_time_callback_t time_callback; // Current time, deadlines of started timers count from it
+
+} timer_wheel_config_t;
+
+// Timers are owned by the caller, the wheel only links them, so there is no limit on their count
+void timer_wheel_init (timer_wheel_config_t const * const init_config);
+void timer_wheel_init_timer (timer_wheel_timer_t * const timer, timer_wheel_callback_t callback);
+
+void timer_wheel_start (timer_wheel_timer_t * const timer, uint32_t delay_ms, uint32_t period_ms);
+void timer_wheel_stop (timer_wheel_timer_t * const timer);
+bool timer_wheel_is_running (timer_wheel_timer_t const * const timer);
+
+// Calls back the expired timers (the time may wrap around, deadlines are up to ~24 days ahead)
+void timer_wheel_process (uint32_t time_ms);
+bool timer_wheel_get_next_deadline (uint32_t * const deadline_ms);
+
+#endif // TIMER_WHEEL_H
\ No newline at end of file
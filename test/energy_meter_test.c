@@ -0,0 +1,165 @@
+/************************************************************
+ *   Author : German Mundinger
+ *   Date   : 2023
+ ************************************************************/
+
+#include "energy_meter.h"
+
+#include <stddef.h>
+
+#include "test.h"
+
+
+#define TEST_ACTIVITY_COUNT 3U
+#define TEST_LOG_ACTIVITY   2U
+
+
+static uint32_t test_time_us;
+static uint8_t test_peripheral_mask;
+
+
+static uint32_t test_get_time_us ();
+static uint8_t test_get_peripherals ();
+
+static void test_init ();
+static void test_accounts ();
+static void test_excluded_activity ();
+static void test_report_split ();
+
+int main ()
+{
+    test_accounts();
+    test_excluded_activity();
+    test_report_split();
+
+    printf("energy_meter: OK\n");
+
+    return EXIT_SUCCESS;
+}
+
+
+uint32_t test_get_time_us ()
+{
+    return test_time_us;
+}
+
+uint8_t test_get_peripherals ()
+{
+    return test_peripheral_mask;
+}
+
+void test_init ()
+{
+    // Close to the wrap around of the microsecond clock
+    test_time_us            = 0xFFFFF000UL;
+    test_peripheral_mask    = 0U;
+
+    energy_meter_config_t config;
+    config.time_callback            = test_get_time_us;
+    config.peripheral_callback      = test_get_peripherals;
+    config.activity_array_size      = TEST_ACTIVITY_COUNT;
+    config.excluded_activity_mask   = (uint8_t)(1U << TEST_LOG_ACTIVITY);
+    config.sleep_current_uA         = 7U;
+    config.base_current_uA          = 1000UL;
+
+    for (size_t i = 0U; i < ENERGY_METER_ACTIVITY_MAX_COUNT; ++i)
+    {
+        config.activity_current_uA_array[i] = 9000U;
+    }
+
+    for (size_t i = 0U; i < ENERGY_METER_PERIPHERAL_COUNT; ++i)
+    {
+        config.peripheral_current_uA_array[i] = 0U;
+    }
+    config.peripheral_current_uA_array[0] = 500U;
+
+    energy_meter_init(&config);
+
+    return;
+}
+
+void test_accounts ()
+{
+    test_init();
+
+    energy_meter_switch(0U);
+    test_time_us += 1000UL;
+
+    // Nested: the peripheral is powered for the inner activity and for the rest of the outer one
+    test_peripheral_mask = 1U;
+    const uint8_t prev_activity = energy_meter_switch(1U);
+    TEST_CHECK(prev_activity == 0U);
+    test_time_us += 500000UL;
+
+    energy_meter_switch(prev_activity);
+    test_time_us += 1000UL;
+
+    test_peripheral_mask = 0U;
+    energy_meter_sleep();
+    test_time_us += 59000000UL;
+
+    energy_meter_report_t report;
+    energy_meter_report(60000UL, &report);
+
+    TEST_CHECK(report.period_ms == 60000UL);
+    TEST_CHECK(report.awake_time_us == 502000UL);
+    TEST_CHECK(report.activity_time_us_array[0] == 2000UL);
+    TEST_CHECK(report.activity_time_us_array[1] == 500000UL);
+    TEST_CHECK(report.peripheral_time_us_array[0] == 501000UL);
+
+    // Base 1000, sleep 7 * 59498 / 60000 = 6, activity 1: 9000 * 500 / 60000 = 75, peripheral 0: 500 * 501 / 60000 = 4
+    TEST_CHECK(report.average_current_uA == 1085UL);
+
+    // The accounts start over
+    energy_meter_report(60000UL, &report);
+
+    TEST_CHECK(report.awake_time_us == 0UL);
+    TEST_CHECK(report.activity_time_us_array[1] == 0UL);
+    TEST_CHECK(report.average_current_uA == 1007UL);
+
+    return;
+}
+
+void test_excluded_activity ()
+{
+    test_init();
+
+    // Logging is reported, but it is estimated as sleep
+    energy_meter_switch(TEST_LOG_ACTIVITY);
+    test_time_us += 30000000UL;
+    energy_meter_sleep();
+    test_time_us += 30000000UL;
+
+    energy_meter_report_t report;
+    energy_meter_report(60000UL, &report);
+
+    TEST_CHECK(report.activity_time_us_array[TEST_LOG_ACTIVITY] == 30000000UL);
+    TEST_CHECK(report.awake_time_us == 0UL);
+    TEST_CHECK(report.average_current_uA == 1007UL);
+
+    return;
+}
+
+void test_report_split ()
+{
+    test_init();
+
+    // An activity in progress is split at the report, its rest goes into the next one
+    energy_meter_switch(1U);
+    test_time_us += 3000UL;
+
+    energy_meter_report_t report;
+    energy_meter_report(1000UL, &report);
+
+    TEST_CHECK(report.activity_time_us_array[1] == 3000UL);
+
+    test_time_us += 2000UL;
+    energy_meter_sleep();
+
+    energy_meter_report(1000UL, &report);
+
+    TEST_CHECK(report.activity_time_us_array[1] == 2000UL);
+    TEST_CHECK(report.awake_time_us == 2000UL);
+
+    return;
+}
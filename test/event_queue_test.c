@@ -0,0 +1,142 @@
+/************************************************************
+ *   Author : German Mundinger
+ *   Date   : 2023
+ ************************************************************/
+
+#include "event_queue.h"
+
+#include <stddef.h>
+
+#include "test.h"
+
+
+static uint32_t test_time_ms;
+
+
+static uint32_t test_get_time_ms ();
+
+static void test_init ();
+static void test_order ();
+static void test_overflow ();
+static void test_index_wrap_around ();
+
+int main ()
+{
+    test_order();
+    test_overflow();
+    test_index_wrap_around();
+
+    printf("event_queue: OK\n");
+
+    return EXIT_SUCCESS;
+}
+
+
+uint32_t test_get_time_ms ()
+{
+    return test_time_ms;
+}
+
+void test_init ()
+{
+    test_time_ms = 0UL;
+
+    event_queue_config_t config;
+    config.time_callback = test_get_time_ms;
+
+    event_queue_init(&config);
+
+    return;
+}
+
+void test_order ()
+{
+    test_init();
+
+    event_queue_record_t record;
+    TEST_CHECK(event_queue_pop(&record) == false);
+
+    // Repeated events are not merged, each keeps its time
+    test_time_ms = 10UL;
+    event_queue_push(1U);
+    test_time_ms = 20UL;
+    event_queue_push(1U);
+    test_time_ms = 30UL;
+    event_queue_push(0U);
+
+    TEST_CHECK(event_queue_pop(&record) == true);
+    TEST_CHECK((record.source == 1U) && (record.time_ms == 10UL));
+    TEST_CHECK(event_queue_pop(&record) == true);
+    TEST_CHECK((record.source == 1U) && (record.time_ms == 20UL));
+    TEST_CHECK(event_queue_pop(&record) == true);
+    TEST_CHECK((record.source == 0U) && (record.time_ms == 30UL));
+
+    TEST_CHECK(event_queue_pop(&record) == false);
+    TEST_CHECK(event_queue_get_lost_count() == 0U);
+
+    return;
+}
+
+void test_overflow ()
+{
+    test_init();
+
+    // A full queue keeps the oldest records and counts the dropped ones
+    for (size_t i = 0U; i < (EVENT_QUEUE_SIZE + 2U); ++i)
+    {
+        test_time_ms = (uint32_t)(i);
+        event_queue_push((uint8_t)(i));
+    }
+    TEST_CHECK(event_queue_get_lost_count() == 2U);
+
+    event_queue_record_t record;
+
+    for (size_t i = 0U; i < EVENT_QUEUE_SIZE; ++i)
+    {
+        TEST_CHECK(event_queue_pop(&record) == true);
+        TEST_CHECK((record.source == (uint8_t)(i)) && (record.time_ms == (uint32_t)(i)));
+    }
+    TEST_CHECK(event_queue_pop(&record) == false);
+
+    // There is room again
+    event_queue_push(7U);
+
+    TEST_CHECK(event_queue_pop(&record) == true);
+    TEST_CHECK(record.source == 7U);
+    TEST_CHECK(event_queue_get_lost_count() == 2U);
+
+    return;
+}
+
+void test_index_wrap_around ()
+{
+    test_init();
+
+    // The 8-bit indexes wrap around several times, with a few records always queued
+    event_queue_record_t record;
+
+    for (size_t i = 0U; i < 3U; ++i)
+    {
+        test_time_ms = (uint32_t)(i);
+        event_queue_push((uint8_t)(i));
+    }
+
+    for (size_t i = 3U; i < 1000U; ++i)
+    {
+        test_time_ms = (uint32_t)(i);
+        event_queue_push((uint8_t)(i));
+
+        TEST_CHECK(event_queue_pop(&record) == true);
+        TEST_CHECK((record.source == (uint8_t)(i - 3U)) && (record.time_ms == (uint32_t)(i - 3U)));
+    }
+
+    for (size_t i = 997U; i < 1000U; ++i)
+    {
+        TEST_CHECK(event_queue_pop(&record) == true);
+        TEST_CHECK(record.time_ms == (uint32_t)(i));
+    }
+    TEST_CHECK(event_queue_pop(&record) == false);
+    TEST_CHECK(event_queue_get_lost_count() == 0U);
+
+    return;
+}
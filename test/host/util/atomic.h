@@ -0,0 +1,15 @@
+/************************************************************
+ *   Author : German Mundinger
+ *   Date   : 2023
+ ************************************************************/
+
+#ifndef UTIL_ATOMIC_H
+#define UTIL_ATOMIC_H
+
+// Host stand-in for the avr-libc header: the tests have no interrupts, the block runs once
+#define ATOMIC_RESTORESTATE 0
+#define ATOMIC_FORCEON      1
+
+#define ATOMIC_BLOCK(type) for (int atomic_once = ((void)(type), 1); atomic_once != 0; atomic_once = 0)
+
+#endif // UTIL_ATOMIC_H
@@ -0,0 +1,247 @@
+/************************************************************
+ *   Author : German Mundinger
+ *   Date   : 2023
+ ************************************************************/
+
+#include "node.mapper.h"
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <string.h>
+
+#include "node/node.types.h"
+#include "std_error/std_error.h"
+
+#include "test.h"
+
+
+#define ARRAY_SIZE(array) (sizeof(array) / sizeof((array)[0]))
+
+#define TEST_BUFFER_SIZE 256U
+
+
+static char stream_buffer[TEST_BUFFER_SIZE];
+static size_t stream_buffer_size;
+
+static node_msg_t parsed_msg;
+static node_mapper_format_t parsed_format;
+static size_t parsed_msg_count;
+
+
+static void test_write_chunk (const char *chunk, size_t chunk_size);
+static void test_take_msg (node_msg_t const * const msg, node_mapper_format_t format, uint16_t request_id);
+
+static void test_init_msg (node_msg_t * const msg, node_command_id_t cmd_id, int32_t value_0);
+static void test_check_msg (node_msg_t const * const msg, node_msg_t const * const expected_msg);
+
+static void test_binary_round_trip (node_msg_t const * const msg);
+static void test_stream_round_trip (node_msg_t const * const msg, node_mapper_format_t format);
+static void test_invalid_data ();
+static void test_overflow ();
+static void test_json_text ();
+
+int main ()
+{
+    node_msg_t msg_array[7];
+    test_init_msg(&msg_array[0], SET_MODE, (int32_t)(GUARD));
+    test_init_msg(&msg_array[1], SET_LIGHT, (int32_t)(LIGHT_ON));
+    test_init_msg(&msg_array[2], UPDATE_TEMPERATURE, NODE_MAPPER_PACK_TEMPERATURE(10130, -2150));
+    test_init_msg(&msg_array[3], (node_command_id_t)(NODE_MAPPER_ENERGY_CMD_ID), NODE_MAPPER_PACK_ENERGY(1234U, 56U));
+    test_init_msg(&msg_array[4], (node_command_id_t)(NODE_MAPPER_ACK_CMD_ID), NODE_MAPPER_PACK_ACK(SET_MODE, 42U));
+    test_init_msg(&msg_array[5], (node_command_id_t)(NODE_MAPPER_HANG_CMD_ID), NODE_MAPPER_PACK_HANG(0x1F3EU));
+    test_init_msg(&msg_array[6], (node_command_id_t)(NODE_MAPPER_MOTION_CMD_ID), NODE_MAPPER_PACK_MOTION(3U, 65535U));
+
+    for (size_t i = 0U; i < ARRAY_SIZE(msg_array); ++i)
+    {
+        test_binary_round_trip(&msg_array[i]);
+        test_stream_round_trip(&msg_array[i], NODE_MAPPER_BINARY_FORMAT);
+    }
+    test_invalid_data();
+    test_overflow();
+    test_json_text();
+
+    for (size_t i = 0U; i < ARRAY_SIZE(msg_array); ++i)
+    {
+        test_stream_round_trip(&msg_array[i], NODE_MAPPER_JSON_FORMAT);
+    }
+
+    printf("node_mapper: OK\n");
+
+    return EXIT_SUCCESS;
+}
+
+
+void test_write_chunk (const char *chunk, size_t chunk_size)
+{
+    TEST_CHECK((stream_buffer_size + chunk_size) <= ARRAY_SIZE(stream_buffer));
+
+    memcpy(&stream_buffer[stream_buffer_size], chunk, chunk_size);
+    stream_buffer_size += chunk_size;
+
+    return;
+}
+
+void test_take_msg (node_msg_t const * const msg, node_mapper_format_t format, uint16_t request_id)
+{
+    TEST_CHECK(request_id == NODE_MAPPER_NO_REQUEST_ID);
+
+    parsed_msg      = *msg;
+    parsed_format   = format;
+    ++parsed_msg_count;
+
+    return;
+}
+
+void test_init_msg (node_msg_t * const msg, node_command_id_t cmd_id, int32_t value_0)
+{
+    memset(msg, 0, sizeof(*msg));
+
+    msg->header.source          = NODE_B01;
+    msg->header.dest_array[0]   = NODE_B02;
+    msg->header.dest_array_size = 1U;
+
+    msg->cmd_id     = cmd_id;
+    msg->value_0    = value_0;
+
+    return;
+}
+
+void test_check_msg (node_msg_t const * const msg, node_msg_t const * const expected_msg)
+{
+    TEST_CHECK(msg->header.source == expected_msg->header.source);
+    TEST_CHECK(msg->header.dest_array_size == expected_msg->header.dest_array_size);
+    TEST_CHECK(msg->header.dest_array[0] == expected_msg->header.dest_array[0]);
+    TEST_CHECK(msg->cmd_id == expected_msg->cmd_id);
+    TEST_CHECK(msg->value_0 == expected_msg->value_0);
+
+    return;
+}
+
+void test_binary_round_trip (node_msg_t const * const msg)
+{
+    std_error_t error;
+    std_error_init(&error);
+
+    char raw_data[TEST_BUFFER_SIZE];
+    size_t raw_data_size = 0U;
+
+    TEST_CHECK(node_mapper_serialize_binary_message(msg, raw_data, ARRAY_SIZE(raw_data), &raw_data_size, &error) == STD_SUCCESS);
+    TEST_CHECK(node_mapper_get_format(raw_data, raw_data_size) == NODE_MAPPER_BINARY_FORMAT);
+
+    node_msg_t decoded_msg;
+    memset(&decoded_msg, 0, sizeof(decoded_msg));
+
+    TEST_CHECK(node_mapper_deserialize_binary_message(raw_data, raw_data_size, &decoded_msg, &error) == STD_SUCCESS);
+
+    test_check_msg(&decoded_msg, msg);
+
+    return;
+}
+
+void test_stream_round_trip (node_msg_t const * const msg, node_mapper_format_t format)
+{
+    std_error_t error;
+    std_error_init(&error);
+
+    stream_buffer_size = 0U;
+
+    TEST_CHECK(node_mapper_serialize_stream(msg, format, test_write_chunk, &error) == STD_SUCCESS);
+    TEST_CHECK(node_mapper_get_format(stream_buffer, stream_buffer_size) == format);
+
+    node_mapper_stream_config_t config;
+    config.msg_callback = test_take_msg;
+    config.node_mask    = NODE_MAPPER_NODE_BIT(NODE_B02);
+
+    node_mapper_init_stream(&config);
+    parsed_msg_count = 0U;
+
+    // Byte by byte, then the message again in one chunk after a separator
+    for (size_t i = 0U; i < stream_buffer_size; ++i)
+    {
+        TEST_CHECK(node_mapper_parse_stream(&stream_buffer[i], 1U, &error) == STD_SUCCESS);
+    }
+    TEST_CHECK(parsed_msg_count == 1U);
+    TEST_CHECK(parsed_format == format);
+
+    test_check_msg(&parsed_msg, msg);
+
+    TEST_CHECK(node_mapper_parse_stream("\n", 1U, &error) == STD_SUCCESS);
+    TEST_CHECK(node_mapper_parse_stream(stream_buffer, stream_buffer_size, &error) == STD_SUCCESS);
+    TEST_CHECK(parsed_msg_count == 2U);
+
+    test_check_msg(&parsed_msg, msg);
+
+    // Another node's message is skipped
+    config.node_mask = NODE_MAPPER_NODE_BIT(NODE_T01);
+
+    node_mapper_init_stream(&config);
+
+    TEST_CHECK(node_mapper_parse_stream(stream_buffer, stream_buffer_size, &error) == STD_SUCCESS);
+    TEST_CHECK(parsed_msg_count == 2U);
+
+    return;
+}
+
+void test_invalid_data ()
+{
+    std_error_t error;
+    std_error_init(&error);
+
+    // Out of the schema range: the encoders write anything, the decoders check it
+    node_msg_t msg;
+    test_init_msg(&msg, SET_MODE, 7);
+
+    char raw_data[TEST_BUFFER_SIZE];
+    size_t raw_data_size = 0U;
+
+    TEST_CHECK(node_mapper_serialize_binary_message(&msg, raw_data, ARRAY_SIZE(raw_data), &raw_data_size, &error) == STD_SUCCESS);
+
+    node_msg_t decoded_msg;
+    TEST_CHECK(node_mapper_deserialize_binary_message(raw_data, raw_data_size, &decoded_msg, &error) == STD_FAILURE);
+
+    // Truncated
+    test_init_msg(&msg, SET_MODE, (int32_t)(ALARM));
+
+    TEST_CHECK(node_mapper_serialize_binary_message(&msg, raw_data, ARRAY_SIZE(raw_data), &raw_data_size, &error) == STD_SUCCESS);
+    TEST_CHECK(node_mapper_deserialize_binary_message(raw_data, raw_data_size - 1U, &decoded_msg, &error) == STD_FAILURE);
+
+    return;
+}
+
+void test_overflow ()
+{
+    std_error_t error;
+    std_error_init(&error);
+
+    node_msg_t msg;
+    test_init_msg(&msg, UPDATE_TEMPERATURE, NODE_MAPPER_PACK_TEMPERATURE(10130, -2150));
+
+    char raw_data[16];
+    size_t raw_data_size = 0U;
+
+    TEST_CHECK(node_mapper_serialize_message(&msg, raw_data, ARRAY_SIZE(raw_data), &raw_data_size, &error) == STD_FAILURE);
+    TEST_CHECK(raw_data_size == 0U);
+
+    TEST_CHECK(node_mapper_serialize_binary_message(&msg, raw_data, 4U, &raw_data_size, &error) == STD_FAILURE);
+
+    return;
+}
+
+void test_json_text ()
+{
+    std_error_t error;
+    std_error_init(&error);
+
+    // Pressure in whole hPa and temperature in 0.1 C, as the hub reads them
+    node_msg_t msg;
+    test_init_msg(&msg, UPDATE_TEMPERATURE, NODE_MAPPER_PACK_TEMPERATURE(10130, -2150));
+
+    char raw_data[TEST_BUFFER_SIZE];
+    size_t raw_data_size = 0U;
+
+    TEST_CHECK(node_mapper_serialize_message(&msg, raw_data, ARRAY_SIZE(raw_data), &raw_data_size, &error) == STD_SUCCESS);
+    TEST_CHECK(raw_data_size == strlen(raw_data));
+    TEST_CHECK(strstr(raw_data, "\"data\":{\"pres_hpa\":1013,\"temp_c\":-21.5}}") != NULL);
+
+    return;
+}
@@ -0,0 +1,218 @@
+/************************************************************
+ *   Author : German Mundinger
+ *   Date   : 2023
+ ************************************************************/
+
+#include "timer_wheel.h"
+
+#include <stddef.h>
+
+#include "test.h"
+
+
+static uint32_t test_time_ms;
+static timer_wheel_timer_t timer_array[3];
+static size_t callback_count_array[3];
+
+
+static uint32_t test_get_time_ms ();
+static void test_timer_0_callback ();
+static void test_timer_1_callback ();
+static void test_stopping_timer_callback ();
+
+static void test_init (uint32_t time_ms);
+static void test_one_shot ();
+static void test_periodic ();
+static void test_next_deadline ();
+static void test_long_pause ();
+static void test_wrap_around ();
+static void test_stop_from_callback ();
+
+int main ()
+{
+    test_one_shot();
+    test_periodic();
+    test_next_deadline();
+    test_long_pause();
+    test_wrap_around();
+    test_stop_from_callback();
+
+    printf("timer_wheel: OK\n");
+
+    return EXIT_SUCCESS;
+}
+
+
+uint32_t test_get_time_ms ()
+{
+    return test_time_ms;
+}
+
+void test_timer_0_callback ()
+{
+    ++callback_count_array[0];
+
+    return;
+}
+
+void test_timer_1_callback ()
+{
+    ++callback_count_array[1];
+
+    return;
+}
+
+void test_stopping_timer_callback ()
+{
+    ++callback_count_array[2];
+
+    timer_wheel_stop(&timer_array[2]);
+
+    return;
+}
+
+void test_init (uint32_t time_ms)
+{
+    test_time_ms = time_ms;
+
+    timer_wheel_config_t config;
+    config.time_callback = test_get_time_ms;
+
+    timer_wheel_init(&config);
+
+    timer_wheel_init_timer(&timer_array[0], test_timer_0_callback);
+    timer_wheel_init_timer(&timer_array[1], test_timer_1_callback);
+    timer_wheel_init_timer(&timer_array[2], test_stopping_timer_callback);
+
+    for (size_t i = 0U; i < 3U; ++i)
+    {
+        callback_count_array[i] = 0U;
+    }
+    return;
+}
+
+void test_one_shot ()
+{
+    test_init(1000UL);
+
+    timer_wheel_start(&timer_array[0], 300UL, 0UL);
+    TEST_CHECK(timer_wheel_is_running(&timer_array[0]) == true);
+
+    timer_wheel_process(1299UL);
+    TEST_CHECK(callback_count_array[0] == 0U);
+
+    timer_wheel_process(1300UL);
+    TEST_CHECK(callback_count_array[0] == 1U);
+    TEST_CHECK(timer_wheel_is_running(&timer_array[0]) == false);
+
+    timer_wheel_process(5000UL);
+    TEST_CHECK(callback_count_array[0] == 1U);
+
+    return;
+}
+
+void test_periodic ()
+{
+    test_init(0UL);
+
+    timer_wheel_start(&timer_array[1], 100UL, 100UL);
+
+    timer_wheel_process(100UL);
+    TEST_CHECK(callback_count_array[1] == 1U);
+
+    // The next deadline is 200, not 350
+    timer_wheel_process(250UL);
+    TEST_CHECK(callback_count_array[1] == 2U);
+
+    // A late timer does not catch up with the missed periods
+    timer_wheel_process(1000UL);
+    TEST_CHECK(callback_count_array[1] == 3U);
+
+    uint32_t deadline_ms;
+    TEST_CHECK(timer_wheel_get_next_deadline(&deadline_ms) == true);
+    TEST_CHECK(deadline_ms == 1100UL);
+    TEST_CHECK(timer_wheel_is_running(&timer_array[1]) == true);
+
+    return;
+}
+
+void test_next_deadline ()
+{
+    test_init(0UL);
+
+    uint32_t deadline_ms;
+    TEST_CHECK(timer_wheel_get_next_deadline(&deadline_ms) == false);
+
+    timer_wheel_start(&timer_array[0], 5000UL, 0UL);
+    timer_wheel_start(&timer_array[1], 200UL, 0UL);
+
+    TEST_CHECK(timer_wheel_get_next_deadline(&deadline_ms) == true);
+    TEST_CHECK(deadline_ms == 200UL);
+
+    timer_wheel_stop(&timer_array[1]);
+    TEST_CHECK(timer_wheel_is_running(&timer_array[1]) == false);
+
+    TEST_CHECK(timer_wheel_get_next_deadline(&deadline_ms) == true);
+    TEST_CHECK(deadline_ms == 5000UL);
+
+    // A restart moves the deadline
+    timer_wheel_start(&timer_array[0], 50UL, 0UL);
+
+    TEST_CHECK(timer_wheel_get_next_deadline(&deadline_ms) == true);
+    TEST_CHECK(deadline_ms == 50UL);
+
+    return;
+}
+
+void test_long_pause ()
+{
+    test_init(0UL);
+
+    // Several turns of the wheel apart, both expire within one processing
+    timer_wheel_start(&timer_array[0], 50UL, 0UL);
+    timer_wheel_start(&timer_array[1], 2000UL, 0UL);
+
+    timer_wheel_process(10000UL);
+    TEST_CHECK(callback_count_array[0] == 1U);
+    TEST_CHECK(callback_count_array[1] == 1U);
+
+    uint32_t deadline_ms;
+    TEST_CHECK(timer_wheel_get_next_deadline(&deadline_ms) == false);
+
+    return;
+}
+
+void test_wrap_around ()
+{
+    test_init(0xFFFFFF00UL);
+
+    timer_wheel_start(&timer_array[0], 0x200UL, 0UL);
+
+    timer_wheel_process(0xFFFFFFFFUL);
+    TEST_CHECK(callback_count_array[0] == 0U);
+
+    timer_wheel_process(0x000000FFUL);
+    TEST_CHECK(callback_count_array[0] == 0U);
+
+    timer_wheel_process(0x00000100UL);
+    TEST_CHECK(callback_count_array[0] == 1U);
+
+    return;
+}
+
+void test_stop_from_callback ()
+{
+    test_init(0UL);
+
+    // A periodic timer is rearmed before its callback, which stops it for good
+    timer_wheel_start(&timer_array[2], 10UL, 10UL);
+
+    timer_wheel_process(10UL);
+    TEST_CHECK(callback_count_array[2] == 1U);
+    TEST_CHECK(timer_wheel_is_running(&timer_array[2]) == false);
+
+    timer_wheel_process(100UL);
+    TEST_CHECK(callback_count_array[2] == 1U);
+
+    return;
+}